@@ -0,0 +1,12 @@
+// app/allocator_types.h - Enclave allocators selectable with ecall_set_allocator
+#ifndef ALLOCATOR_TYPES_H
+#define ALLOCATOR_TYPES_H
+
+#define ALLOCATOR_HEAP 0
+#define ALLOCATOR_ARENA 1
+
+// Per-TCS arena size; larger requests fall back to the trusted heap
+#define ARENA_CAPACITY (1024 * 1024)
+#define ARENA_ALIGNMENT 64
+
+#endif // ALLOCATOR_TYPES_H
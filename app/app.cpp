@@ -3,33 +3,510 @@
 #include <string>
 #include <getopt.h>
 #include <fstream>
+#include <vector>
 #include "sgx_urts.h"
 #include "enclave_u.h"
 #include "mitigation_config.h"
 #include "benchmark_runner.h"
 #include "config_parser.h"
+#include "sweep_runner.h"
+#include "run_controller.h"
+#include "cycle_counter.h"
+#include "sealed_stream_format.h"
+#include "io_backend.h"
+#include "epc_info.h"
+#include "allocator_types.h"
+#include "enclave_variants.h"
+#include "enclave_pool.h"
+#include "trace_report.h"
 
 extern MitigationConfig g_app_config;
 sgx_enclave_id_t global_eid = 0;
 
-static int initialize_enclave() {
-    sgx_status_t ret;
-    sgx_launch_token_t token = {0};
-    int updated = 0;
-    ret = sgx_create_enclave("enclave.signed.so", SGX_DEBUG_FLAG,
-                             &token, &updated, &global_eid, nullptr);
-    return (ret == SGX_SUCCESS) ? 0 : -1;
+static int initialize_enclave(const sgx_uswitchless_config_t* switchless, const std::string& image) {
+    if (create_enclave(image, switchless, &global_eid) != SGX_SUCCESS) return -1;
+
+    static bool reported = false;
+    int trusted_tsc = 0;
+    uint64_t trusted_overhead = 0;
+    ecall_probe_trusted_timer(global_eid, &trusted_tsc, &trusted_overhead);
+    if (!reported) {
+        std::cout << "Trusted TSC:          "
+                  << (trusted_tsc ? "available, overhead " + std::to_string(trusted_overhead) + " cycles"
+                                  : std::string("unavailable (SGX1)")) << "\n";
+        reported = true;
+    }
+    return 0;
+}
+
+static void print_timer_info() {
+    std::cout << "Timer configuration:\n";
+    std::cout << "  Invariant TSC:        " << (CycleCounter::invariant() ? "yes" : "no") << "\n";
+    std::cout << "  TSC frequency:        " << CycleCounter::frequency_hz() / 1e9 << " GHz ("
+              << CycleCounter::frequency_origin() << ")\n";
+    std::cout << "  Timer overhead:       " << CycleCounter::overhead() << " cycles (subtracted)\n";
+}
+
+static void print_cache_info(const CacheConditioner& cache) {
+    const CacheTopology& caches = cache.topology();
+    std::cout << "Cache state:          " << cache.name();
+    if (cache.per_operation()) {
+        std::cout << ", " << cache.footprint() / 1024 << " KB read before each operation";
+    }
+    std::cout << " (L1D " << caches.l1d_bytes / 1024 << " KB, L2 " << caches.l2_bytes / 1024
+              << " KB, LLC " << caches.llc_bytes / 1024 << " KB, " << caches.line_bytes
+              << "-byte lines)\n";
+}
+
+static const char* transition_name(TransitionMode mode) {
+    return mode == TransitionMode::Switchless ? "switchless" : "classic";
+}
+
+static const char* allocator_name(int allocator) {
+    return allocator == ALLOCATOR_HEAP ? "heap" : "arena";
+}
+
+static void print_result(const BenchmarkResult& result, int iterations, bool per_op) {
+    double time_per_op = (result.time_ms * 1000.0) / iterations;
+    std::cout << "Results: " << result.time_ms << "ms total, " << time_per_op << "μs per operation, "
+              << result.cycles_per_op << " cycles per operation ("
+              << CycleCounter::cycles_to_ns(result.cycles_per_op) << " ns)\n";
+    if (per_op) {
+        const LatencyStats& lat = result.latency;
+        std::cout << "Latency (cycles): min " << lat.min_cycles << ", p50 " << lat.p50_cycles
+                  << ", p90 " << lat.p90_cycles << ", p99 " << lat.p99_cycles
+                  << ", p99.9 " << lat.p999_cycles << ", max " << lat.max_cycles
+                  << ", stddev " << lat.stddev_cycles << "\n";
+    }
+    if (result.perf.valid) {
+        std::cout << "Counters per operation:";
+        for (int event = 0; event < PERF_EVENT_COUNT; event++) {
+            if (!result.perf.supported[event]) continue;
+            std::cout << " " << PerfCounterGroup::event_name(event) << " "
+                      << result.perf.per_op[event];
+        }
+        std::cout << "\n";
+    }
+}
+
+static void write_result_csv(const std::string& output_file, const std::string& test_type,
+                             const std::string& mitigations, int iterations,
+                             const BenchmarkResult& result, TransitionMode mode) {
+    double time_per_op = (result.time_ms * 1000.0) / iterations;
+    std::ofstream csv(output_file, std::ios::app);
+    csv << test_type << "," << mitigations << ","
+        << iterations << "," << result.time_ms << "," << time_per_op << ","
+        << result.cycles << "," << result.cycles_per_op << ","
+        << result.latency.min_cycles << "," << result.latency.p50_cycles << ","
+        << result.latency.p90_cycles << "," << result.latency.p99_cycles << ","
+        << result.latency.p999_cycles << "," << result.latency.max_cycles << ","
+        << result.latency.stddev_cycles << "," << transition_name(mode) << ","
+        << CycleCounter::cycles_to_ns(result.cycles_per_op);
+    write_perf_columns(csv, result.perf);
+    csv << "\n";
+}
+
+static void print_scaling(const std::vector<ScalingPoint>& curve) {
+    std::cout << "threads  ops/s        mean cycles/op  worst thread cycles/op\n";
+    for (const ScalingPoint& point : curve) {
+        double sum = 0.0, worst = 0.0;
+        int failed = 0;
+        for (const ThreadResult& t : point.per_thread) {
+            sum += t.cycles_per_op;
+            if (t.cycles_per_op > worst) worst = t.cycles_per_op;
+            failed += t.failed_calls;
+        }
+        std::cout << point.threads << "        " << point.ops_per_sec << "  "
+                  << sum / static_cast<double>(point.per_thread.size()) << "  " << worst;
+        if (failed > 0) {
+            std::cout << "  (" << failed << " failed calls, check TCSNum)";
+        }
+        std::cout << "\n";
+    }
+}
+
+static void write_scaling_csv(const std::string& output_file, const std::string& test_type,
+                              const std::string& mitigations, int iterations,
+                              const std::vector<ScalingPoint>& curve, TransitionMode mode) {
+    // One row per worker: test_type,mitigations,threads,thread_id,cpu,iterations,
+    // wall_ms,ops_per_sec,cycles_per_op,p50_cycles,p99_cycles,failed_calls,transition
+    std::ofstream csv(output_file, std::ios::app);
+    for (const ScalingPoint& point : curve) {
+        for (const ThreadResult& t : point.per_thread) {
+            csv << test_type << "," << mitigations << "," << point.threads << ","
+                << t.thread_id << "," << t.cpu << "," << iterations << ","
+                << point.wall_ms << "," << point.ops_per_sec << "," << t.cycles_per_op << ","
+                << t.latency.p50_cycles << "," << t.latency.p99_cycles << ","
+                << t.failed_calls << "," << transition_name(mode) << "\n";
+        }
+    }
+}
+
+static void write_batch_csv(const std::string& output_file, const std::string& test_type,
+                            const std::string& mitigations, int iterations, int batch_size,
+                            const BenchmarkResult& result) {
+    // test_type,mitigations,batch_size,iterations,total_time_ms,cycles_per_op,
+    // p50_batch_cycles,p99_batch_cycles
+    std::ofstream csv(output_file, std::ios::app);
+    csv << test_type << "," << mitigations << "," << batch_size << "," << iterations << ","
+        << result.time_ms << "," << result.cycles_per_op << ","
+        << result.latency.p50_cycles << "," << result.latency.p99_cycles << "\n";
+}
+
+static void print_stream_result(const StreamResult& result) {
+    std::cout << result.plain_bytes << " bytes, " << result.chunk_size << " B chunks, "
+              << result.passes << " passes: seal " << result.seal_mb_per_s << " MB/s ("
+              << result.seal_cycles_per_byte << " cycles/B), unseal " << result.unseal_mb_per_s
+              << " MB/s (" << result.unseal_cycles_per_byte << " cycles/B)"
+              << (result.verified ? "" : " CHECKSUM MISMATCH") << "\n";
+}
+
+static void write_stream_csv(const std::string& output_file, const std::string& test_type,
+                             const std::string& mitigations, const StreamResult& result) {
+    // test_type,mitigations,plain_bytes,chunk_size,passes,seal_mb_per_s,unseal_mb_per_s,
+    // seal_cycles_per_byte,unseal_cycles_per_byte,verified
+    std::ofstream csv(output_file, std::ios::app);
+    csv << test_type << "," << mitigations << "," << result.plain_bytes << ","
+        << result.chunk_size << "," << result.passes << "," << result.seal_mb_per_s << ","
+        << result.unseal_mb_per_s << "," << result.seal_cycles_per_byte << ","
+        << result.unseal_cycles_per_byte << "," << (result.verified ? 1 : 0) << "\n";
+}
+
+static void print_payload_points(const std::vector<PayloadPoint>& points) {
+    std::cout << "payload   marshalled cycles/op  ring cycles/op  copy cycles  copy share\n";
+    for (const PayloadPoint& point : points) {
+        double copy = point.marshalled.cycles_per_op - point.ring.cycles_per_op;
+        double share = point.marshalled.cycles_per_op > 0.0
+            ? 100.0 * copy / point.marshalled.cycles_per_op : 0.0;
+        std::cout << point.payload << "  " << point.marshalled.cycles_per_op << " ("
+                  << CycleCounter::cycles_to_ns(point.marshalled.cycles_per_op) << " ns)  "
+                  << point.ring.cycles_per_op << " ("
+                  << CycleCounter::cycles_to_ns(point.ring.cycles_per_op) << " ns)  "
+                  << copy << "  " << share << "%\n";
+    }
+}
+
+static void write_payload_csv(const std::string& output_file, const std::string& test_type,
+                              const std::string& mitigations, int iterations,
+                              const std::vector<PayloadPoint>& points) {
+    // test_type,mitigations,payload_bytes,iterations,marshalled_cycles_per_op,ring_cycles_per_op,
+    // marshalled_ns_per_op,ring_ns_per_op,marshalled_p99_cycles,ring_p99_cycles
+    std::ofstream csv(output_file, std::ios::app);
+    for (const PayloadPoint& point : points) {
+        csv << test_type << "," << mitigations << "," << point.payload << "," << iterations << ","
+            << point.marshalled.cycles_per_op << "," << point.ring.cycles_per_op << ","
+            << CycleCounter::cycles_to_ns(point.marshalled.cycles_per_op) << ","
+            << CycleCounter::cycles_to_ns(point.ring.cycles_per_op) << ","
+            << point.marshalled.latency.p99_cycles << "," << point.ring.latency.p99_cycles << "\n";
+    }
+}
+
+static void print_marshal_points(const std::vector<MarshalPoint>& points) {
+    std::cout << "direction         payload   cycles/op    ns/op    MB/s\n";
+    for (const MarshalPoint& point : points) {
+        double ns = CycleCounter::cycles_to_ns(point.result.cycles_per_op);
+        std::cout << point.direction << "  " << point.payload << "  " << point.result.cycles_per_op
+                  << "  " << ns << "  " << (ns > 0.0 ? static_cast<double>(point.payload) / ns * 1e3 : 0.0)
+                  << "\n";
+    }
+}
+
+static void write_marshal_csv(const std::string& output_file, const std::string& test_type,
+                              const std::string& mitigations,
+                              const std::vector<MarshalPoint>& points) {
+    // test_type,mitigations,direction,payload_bytes,iterations,cycles_per_op,ns_per_op,bytes_per_s
+    std::ofstream csv(output_file, std::ios::app);
+    for (const MarshalPoint& point : points) {
+        double ns = CycleCounter::cycles_to_ns(point.result.cycles_per_op);
+        csv << test_type << "," << mitigations << "," << point.direction << "," << point.payload << ","
+            << point.iterations << "," << point.result.cycles_per_op << "," << ns << ","
+            << (ns > 0.0 ? static_cast<double>(point.payload) / ns * 1e9 : 0.0) << "\n";
+    }
+}
+
+static void print_working_set(const std::vector<WorkingSetPoint>& points, uint64_t epc_bytes) {
+    std::cout << "pattern     bytes       x EPC    cycles/access  ns/access\n";
+    for (const WorkingSetPoint& point : points) {
+        std::cout << point.pattern << "  " << point.bytes << "  ";
+        if (epc_bytes > 0) {
+            std::cout << static_cast<double>(point.bytes) / static_cast<double>(epc_bytes);
+        } else {
+            std::cout << "-";
+        }
+        std::cout << "  " << point.cycles_per_access << "  "
+                  << CycleCounter::cycles_to_ns(point.cycles_per_access);
+        if (point.perf.valid) {
+            for (int event = 0; event < PERF_EVENT_COUNT; event++) {
+                if (!point.perf.supported[event]) continue;
+                std::cout << "  " << PerfCounterGroup::event_name(event) << " "
+                          << point.perf.per_op[event];
+            }
+        }
+        std::cout << "\n";
+    }
+}
+
+static void write_working_set_csv(const std::string& output_file, const std::string& test_type,
+                                  const std::string& mitigations,
+                                  const std::vector<WorkingSetPoint>& points, uint64_t epc_bytes) {
+    // test_type,mitigations,pattern,bytes,epc_bytes,accesses,cycles_per_access,ns_per_access,
+    // <event>_per_access...
+    std::ofstream csv(output_file, std::ios::app);
+    for (const WorkingSetPoint& point : points) {
+        csv << test_type << "," << mitigations << "," << point.pattern << "," << point.bytes << ","
+            << epc_bytes << "," << point.accesses << "," << point.cycles_per_access << ","
+            << CycleCounter::cycles_to_ns(point.cycles_per_access);
+        write_perf_columns(csv, point.perf);
+        csv << "\n";
+    }
+}
+
+static void print_crypto_points(const std::vector<CryptoPoint>& points) {
+    std::cout << "operation        bytes     cycles/op    cycles/byte  MB/s\n";
+    for (const CryptoPoint& point : points) {
+        std::cout << point.op << "  " << point.bytes << "  " << point.cycles_per_op << "  "
+                  << point.cycles_per_byte << "  " << point.mb_per_s << "\n";
+    }
+}
+
+static void write_crypto_csv(const std::string& output_file, const std::string& test_type,
+                             const std::string& mitigations,
+                             const std::vector<CryptoPoint>& points) {
+    // test_type,mitigations,operation,bytes,ops,cycles_per_op,cycles_per_byte,mb_per_s
+    std::ofstream csv(output_file, std::ios::app);
+    for (const CryptoPoint& point : points) {
+        csv << test_type << "," << mitigations << "," << point.op << "," << point.bytes << ","
+            << point.ops << "," << point.cycles_per_op << "," << point.cycles_per_byte << ","
+            << point.mb_per_s << "\n";
+    }
+}
+
+static void print_flush_points(const std::vector<FlushPoint>& points) {
+    std::cout << "strategy              bytes     cycles/op    cycles/line\n";
+    for (const FlushPoint& point : points) {
+        std::cout << point.strategy << "  " << point.bytes << "  " << point.cycles_per_op << "  "
+                  << point.cycles_per_line << "\n";
+    }
+}
+
+static void write_flush_csv(const std::string& output_file, const std::string& test_type,
+                            const std::string& mitigations, const std::vector<FlushPoint>& points) {
+    // test_type,mitigations,strategy,bytes,ops,cycles_per_op,cycles_per_line
+    std::ofstream csv(output_file, std::ios::app);
+    for (const FlushPoint& point : points) {
+        csv << test_type << "," << mitigations << "," << point.strategy << "," << point.bytes << ","
+            << point.ops << "," << point.cycles_per_op << "," << point.cycles_per_line << "\n";
+    }
+}
+
+static void print_memops_points(const std::vector<MemopsPoint>& points) {
+    std::cout << "impl  op    bytes     cycles/byte  MB/s\n";
+    for (const MemopsPoint& point : points) {
+        std::cout << point.implementation << "  " << point.op << "  " << point.bytes << "  "
+                  << point.cycles_per_byte << "  " << point.mb_per_s << "\n";
+    }
+}
+
+static void write_memops_csv(const std::string& output_file, const std::string& test_type,
+                             const std::string& mitigations,
+                             const std::vector<MemopsPoint>& points) {
+    // test_type,mitigations,implementation,operation,bytes,ops,cycles_per_byte,mb_per_s
+    std::ofstream csv(output_file, std::ios::app);
+    for (const MemopsPoint& point : points) {
+        csv << test_type << "," << mitigations << "," << point.implementation << "," << point.op << ","
+            << point.bytes << "," << point.ops << "," << point.cycles_per_byte << ","
+            << point.mb_per_s << "\n";
+    }
+}
+
+static void print_seal_key_points(const std::vector<SealKeyPoint>& points) {
+    std::cout << "path         cycles/op    ns/op\n";
+    double derive = 0.0, cached = 0.0;
+    for (const SealKeyPoint& point : points) {
+        std::cout << point.path << "  " << point.result.cycles_per_op << "  "
+                  << CycleCounter::cycles_to_ns(point.result.cycles_per_op) << "\n";
+        if (point.path == "derive") derive = point.result.cycles_per_op;
+        if (point.path == "cached") cached = point.result.cycles_per_op;
+    }
+    std::cout << "EGETKEY per read (derive - cached): " << derive - cached << " cycles\n";
+}
+
+static double cycles_to_us(double cycles) {
+    return CycleCounter::cycles_to_ns(cycles) / 1000.0;
+}
+
+static void print_startup_points(const std::vector<StartupPoint>& points) {
+    std::cout << "image                       heap      stack    tcs  create p50/p99 (us)  first ecall (us)"
+                 "  destroy p50 (us)  pooled (us)\n";
+    for (const StartupPoint& point : points) {
+        std::cout << point.image << "  " << point.heap_bytes << "  " << point.stack_bytes << "  "
+                  << point.tcs << "  " << cycles_to_us(static_cast<double>(point.create.p50_cycles))
+                  << "/" << cycles_to_us(static_cast<double>(point.create.p99_cycles)) << "  "
+                  << cycles_to_us(static_cast<double>(point.first_ecall.p50_cycles)) << "  "
+                  << cycles_to_us(static_cast<double>(point.destroy.p50_cycles)) << "  "
+                  << cycles_to_us(point.pooled_cycles) << "\n";
+    }
+}
+
+static void write_startup_csv(const std::string& output_file, const std::vector<StartupPoint>& points) {
+    // test_type,image,heap_bytes,stack_bytes,tcs,runs,create_p50_cycles,create_p99_cycles,
+    // create_max_cycles,first_ecall_p50_cycles,destroy_p50_cycles,destroy_p99_cycles,pooled_cycles
+    std::ofstream csv(output_file, std::ios::app);
+    for (const StartupPoint& point : points) {
+        csv << "startup," << point.image << "," << point.heap_bytes << "," << point.stack_bytes << ","
+            << point.tcs << "," << point.runs << "," << point.create.p50_cycles << ","
+            << point.create.p99_cycles << "," << point.create.max_cycles << ","
+            << point.first_ecall.p50_cycles << "," << point.destroy.p50_cycles << ","
+            << point.destroy.p99_cycles << "," << point.pooled_cycles << "\n";
+    }
+}
+
+static void print_hardening_points(const std::vector<HardeningPoint>& points) {
+    std::cout << "test            placement     cycles/op\n";
+    for (const HardeningPoint& point : points) {
+        std::cout << point.test << "  " << point.placement << "  " << point.result.cycles_per_op << "\n";
+    }
+}
+
+// Compiler-hardening cost: the same test and runtime mitigations in
+// another enclave variant, against the reference (first) variant
+static void print_variant_overhead(const std::string& variant, const std::string& reference,
+                                   double cycles, double reference_cycles) {
+    if (variant == reference || reference_cycles <= 0.0) return;
+    std::cout << "Compiler hardening (" << variant << " vs " << reference << "): "
+              << (cycles / reference_cycles - 1.0) * 100.0 << "%\n";
+}
+
+static void print_overhead(const std::string& mitigations, const RepeatedResult& baseline,
+                           const RepeatedResult& candidate, const OverheadEstimate& estimate) {
+    std::cout << "none: " << baseline.mean << " cycles/op (" << baseline.kept.size() << "/"
+              << baseline.samples.size() << " repetitions kept)\n";
+    std::cout << mitigations << ": " << candidate.mean << " cycles/op (" << candidate.kept.size()
+              << "/" << candidate.samples.size() << " repetitions kept)\n";
+    std::cout << "Overhead: " << estimate.overhead_pct << "% [95% CI " << estimate.ci_low_pct
+              << "%, " << estimate.ci_high_pct << "%] "
+              << (estimate.significant ? "significant" : "not significant") << "\n";
+}
+
+static void write_overhead_csv(const std::string& output_file, const std::string& test_type,
+                               const std::string& mitigations, int iterations,
+                               const RepeatedResult& baseline, const RepeatedResult& candidate,
+                               const OverheadEstimate& estimate, TransitionMode mode) {
+    // test_type,mitigations,iterations,repetitions_kept,baseline_cycles_per_op,
+    // cycles_per_op,overhead_pct,ci_low_pct,ci_high_pct,significant,transition
+    std::ofstream csv(output_file, std::ios::app);
+    csv << test_type << "," << mitigations << "," << iterations << ","
+        << candidate.kept.size() << "," << baseline.mean << "," << candidate.mean << ","
+        << estimate.overhead_pct << "," << estimate.ci_low_pct << "," << estimate.ci_high_pct << ","
+        << (estimate.significant ? 1 : 0) << "," << transition_name(mode) << "\n";
+}
+
+// Turns enclave tracing on and discards earlier events; false (with the
+// reason printed) when the enclave cannot trace
+static bool start_trace() {
+    int status = TRACE_STATUS_NOT_BUILT;
+    ecall_trace_enable(global_eid, &status, 1);
+    trace_report::clear();
+    if (status == TRACE_STATUS_ENABLED) return true;
+    if (status == TRACE_STATUS_NO_TIMER) {
+        std::cerr << "Tracing needs RDTSC inside the enclave (SGX2 or simulation mode)\n";
+    } else {
+        std::cerr << "Tracing is not built into this enclave; rebuild with 'make TRACE=1'\n";
+    }
+    return false;
+}
+
+static void print_trace_breakdown(const std::vector<TracePhaseStats>& phases, uint64_t unmatched) {
+    uint64_t traced = 0;
+    for (const TracePhaseStats& phase : phases) traced += phase.self_cycles;
+
+    std::cout << "Enclave phases (self time excludes nested phases):\n";
+    for (const TracePhaseStats& phase : phases) {
+        std::cout << "  " << trace_report::phase_name(phase.phase) << ": " << phase.spans
+                  << " spans, " << phase.total_cycles / phase.spans << " cycles per span, "
+                  << phase.self_cycles / phase.spans << " self ("
+                  << (traced ? 100 * phase.self_cycles / traced : 0) << "% of traced time)\n";
+    }
+    if (unmatched > 0) {
+        std::cout << unmatched << " trace events without a matching begin/end\n";
+    }
+}
+
+// Stops tracing, drains every TCS ring and reports the run's phases
+static void finish_trace(const std::string& path) {
+    int status = TRACE_STATUS_DISABLED;
+    ecall_trace_enable(global_eid, &status, 0);
+    ecall_trace_drain(global_eid);
+
+    std::vector<trace_event_t> events = trace_report::events();
+    uint64_t unmatched = 0;
+    print_trace_breakdown(trace_report::breakdown(events, &unmatched), unmatched);
+    if (trace_report::write_chrome_trace(path, events, CycleCounter::frequency_hz())) {
+        std::cout << events.size() << " trace events written to " << path << "\n";
+    } else {
+        std::cerr << "Failed to write trace " << path << "\n";
+    }
+    trace_report::clear();
+}
+
+// FILE.json becomes FILE_<suffix>.json
+static std::string trace_path(const std::string& path, const std::string& suffix) {
+    size_t dot = path.find_last_of('.');
+    size_t slash = path.find_last_of('/');
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) {
+        return path + "_" + suffix;
+    }
+    return path.substr(0, dot) + "_" + suffix + path.substr(dot);
 }
 
 static void print_usage(const char* program) {
     std::cout << "Usage: " << program << " [options]\n";
     std::cout << "Options:\n";
-    std::cout << "  -t, --test TYPE          Test type (ecall, pure_ocall, pingpong, untrusted_file, sealed_file, crypto)\n";
+    std::cout << "  -t, --test TYPE          Test type (ecall, pure_ocall, pingpong, untrusted_file, sealed_file, crypto,\n";
+    std::cout << "                           sealed_stream, zero_copy, marshal, working_set, alloc,\n";
+    std::cout << "                           sealed_cached, sealed_derive, seal_key, crypto_suite, memops, flush,\n";
+    std::cout << "                           hardening, startup)\n";
     std::cout << "  -i, --iterations N       Number of iterations (default: 1000)\n";
+    std::cout << "                           (startup: create/destroy cycles per image, at most 100)\n";
     std::cout << "  -f, --file FILE          File for read tests (default: test.txt)\n";
     std::cout << "  -m, --mitigations LIST   Comma-separated mitigations (e.g., lfence,cache,all,none)\n";
     std::cout << "  -o, --output FILE        Output CSV file\n";
     std::cout << "  -s, --setup              Create sealed test files\n";
+    std::cout << "  -p, --per-op             Time each operation and report latency percentiles\n";
+    std::cout << "  -j, --threads N          Run the test on 1..N pinned threads and report scaling\n";
+    std::cout << "  -x, --transition MODE    classic, switchless or both (default: classic)\n";
+    std::cout << "      --uworkers N         Switchless untrusted worker threads (default: 1)\n";
+    std::cout << "      --tworkers N         Switchless trusted worker threads (default: 1)\n";
+    std::cout << "      --retries N          Switchless retries before fallback (default: 20000)\n";
+    std::cout << "      --sizes LIST         sealed_stream plaintext sizes (default: 64K,1M,16M,128M) or\n";
+    std::cout << "                           zero_copy payload sizes (default: 64,1K,4K,8K,64K,256K,1M) or\n";
+    std::cout << "                           marshal payload sizes (default: 0,64,256,1K,4K,16K,64K,256K,1M,4M) or\n";
+    std::cout << "                           working_set sizes (default: 64K doubling up to 4x EPC) or\n";
+    std::cout << "                           crypto_suite or memops sizes (default: 64,256,1K,4K,16K,64K,256K,1M) or\n";
+    std::cout << "                           flush region sizes (default: 64,512,4K,32K,256K,1M)\n";
+    std::cout << "      --chunk-size N       sealed_stream chunk size (default: 64K)\n";
+    std::cout << "      --io-backend NAME    Untrusted file I/O: stdio, pread, mmap or direct (default: stdio)\n";
+    std::cout << "      --cache-state STATE  Cache state each operation starts from: warm, cold_llc, cold_l1d\n";
+    std::cout << "                           or tlb (default: warm); cold states are set up untimed before\n";
+    std::cout << "                           every ECALL, and CSV test names get a _STATE suffix\n";
+    std::cout << "      --flush NAME         Cache flush strategy: clflush (immediate clflush + mfence, as in\n";
+    std::cout << "                           the baseline), or queued auto, clflushopt or clwb (default: clflush)\n";
+    std::cout << "      --hardening MODE     Speculation hardening: lfence (barriers in loops) or mask (index\n";
+    std::cout << "                           masking, barriers at trust boundaries) (default: lfence)\n";
+    std::cout << "      --barrier-stride N   Loop iterations between lfence barriers, a power of two or 0\n";
+    std::cout << "                           for ECALL entry only (default: 64)\n";
+    std::cout << "      --enclave-variant V  Load enclave_V.signed.so from 'make variants', or 'all' to run\n";
+    std::cout << "                           every built variant; CSV test names get a _V suffix\n";
+    std::cout << "      --allocator NAME     Enclave per-call buffers: heap, arena or both (default: arena);\n";
+    std::cout << "                           when given, CSV test names get an _heap/_arena suffix\n";
+    std::cout << "  -b, --batch-size LIST    Run via ecall_batch with these batch sizes (e.g. 1,64 or sweep)\n";
+    std::cout << "  -M, --matrix FILE        Run a test x mitigation sweep in one process (see sweep_runner.h)\n";
+    std::cout << "  -r, --repetitions K      Repeat K times against 'none' and report overhead with a 95% CI\n";
+    std::cout << "  -P, --perf               Collect hardware counters (perf_event_open) per operation\n";
+    std::cout << "  -d, --dispatch MODE      runtime (check flags per call) or static (specialized workloads)\n";
+    std::cout << "      --trace FILE         Trace enclave phases (needs 'make TRACE=1'), print a per-phase\n";
+    std::cout << "                           breakdown and write Chrome trace JSON to FILE (one file per\n";
+    std::cout << "                           run, suffixed, when several runs are made)\n";
     std::cout << "  -h, --help               Show this help\n";
 }
 
@@ -39,8 +516,29 @@ int main(int argc, char* argv[]) {
     std::string filename = "test.txt";
     std::string output_file;
     std::string mitigations = "none";
+    std::string transition = "classic";
+    std::string dispatch = "runtime";
+    std::string sizes;
+    std::string chunk_size = "64K";
+    std::string allocator;
+    std::string enclave_variant;
+    std::string flush_strategy = "clflush";
+    std::string cache_state = "warm";
+    std::string hardening = "lfence";
+    long long barrier_stride = HARDENING_DEFAULT_STRIDE;
     bool setup_files = false;
+    bool per_op = false;
+    int threads = 0;
+    std::string batch_sizes;
+    std::string matrix_file;
+    int repetitions = 0;
+    bool perf = false;
+    std::string trace_file;
+    SwitchlessOptions switchless_options = {1, 1, 20000, 20000};
 
+    enum { OPT_UWORKERS = 256, OPT_TWORKERS, OPT_RETRIES, OPT_SIZES, OPT_CHUNK_SIZE, OPT_IO_BACKEND,
+           OPT_ALLOCATOR, OPT_FLUSH, OPT_HARDENING, OPT_BARRIER_STRIDE,
+           OPT_ENCLAVE_VARIANT, OPT_TRACE, OPT_CACHE_STATE };
     static struct option long_options[] = {
         {"test", required_argument, 0, 't'},
         {"iterations", required_argument, 0, 'i'},
@@ -48,12 +546,33 @@ int main(int argc, char* argv[]) {
         {"mitigations", required_argument, 0, 'm'},
         {"output", required_argument, 0, 'o'},
         {"setup", no_argument, 0, 's'},
+        {"per-op", no_argument, 0, 'p'},
+        {"threads", required_argument, 0, 'j'},
+        {"transition", required_argument, 0, 'x'},
+        {"uworkers", required_argument, 0, OPT_UWORKERS},
+        {"tworkers", required_argument, 0, OPT_TWORKERS},
+        {"retries", required_argument, 0, OPT_RETRIES},
+        {"sizes", required_argument, 0, OPT_SIZES},
+        {"chunk-size", required_argument, 0, OPT_CHUNK_SIZE},
+        {"io-backend", required_argument, 0, OPT_IO_BACKEND},
+        {"allocator", required_argument, 0, OPT_ALLOCATOR},
+        {"enclave-variant", required_argument, 0, OPT_ENCLAVE_VARIANT},
+        {"flush", required_argument, 0, OPT_FLUSH},
+        {"hardening", required_argument, 0, OPT_HARDENING},
+        {"barrier-stride", required_argument, 0, OPT_BARRIER_STRIDE},
+        {"trace", required_argument, 0, OPT_TRACE},
+        {"cache-state", required_argument, 0, OPT_CACHE_STATE},
+        {"batch-size", required_argument, 0, 'b'},
+        {"matrix", required_argument, 0, 'M'},
+        {"repetitions", required_argument, 0, 'r'},
+        {"perf", no_argument, 0, 'P'},
+        {"dispatch", required_argument, 0, 'd'},
         {"help", no_argument, 0, 'h'},
         {0, 0, 0, 0}
     };
 
     int opt;
-    while ((opt = getopt_long(argc, argv, "t:i:f:m:o:sh", long_options, nullptr)) != -1) {
+    while ((opt = getopt_long(argc, argv, "t:i:f:m:o:spj:x:b:M:r:Pd:h", long_options, nullptr)) != -1) {
         switch (opt) {
             case 't': test_type = optarg; break;
             case 'i': iterations = std::stoi(optarg); break;
@@ -61,74 +580,398 @@ int main(int argc, char* argv[]) {
             case 'm': mitigations = optarg; break;
             case 'o': output_file = optarg; break;
             case 's': setup_files = true; break;
+            case 'p': per_op = true; break;
+            case 'j': threads = std::stoi(optarg); break;
+            case 'x': transition = optarg; break;
+            case 'b': batch_sizes = optarg; break;
+            case 'M': matrix_file = optarg; break;
+            case 'r': repetitions = std::stoi(optarg); break;
+            case 'P': perf = true; break;
+            case 'd': dispatch = optarg; break;
+            case OPT_UWORKERS: switchless_options.untrusted_workers = static_cast<uint32_t>(std::stoul(optarg)); break;
+            case OPT_TWORKERS: switchless_options.trusted_workers = static_cast<uint32_t>(std::stoul(optarg)); break;
+            case OPT_RETRIES: switchless_options.retries_before_fallback = static_cast<uint32_t>(std::stoul(optarg)); break;
+            case OPT_SIZES: sizes = optarg; break;
+            case OPT_CHUNK_SIZE: chunk_size = optarg; break;
+            case OPT_IO_BACKEND:
+                if (!io_backend::select(optarg)) {
+                    std::cerr << "Unknown I/O backend: " << optarg << "\n";
+                    return 1;
+                }
+                break;
+            case OPT_ALLOCATOR: allocator = optarg; break;
+            case OPT_ENCLAVE_VARIANT: enclave_variant = optarg; break;
+            case OPT_FLUSH: flush_strategy = optarg; break;
+            case OPT_HARDENING: hardening = optarg; break;
+            case OPT_BARRIER_STRIDE: barrier_stride = std::stoll(optarg); break;
+            case OPT_TRACE: trace_file = optarg; break;
+            case OPT_CACHE_STATE: cache_state = optarg; break;
             case 'h': print_usage(argv[0]); return 0;
             default: print_usage(argv[0]); return 1;
         }
     }
 
-    parse_mitigations(mitigations);
-    print_config();
+    std::vector<TransitionMode> modes;
+    if (transition == "classic" || transition == "both") modes.push_back(TransitionMode::Classic);
+    if (transition == "switchless" || transition == "both") modes.push_back(TransitionMode::Switchless);
+    if (modes.empty()) {
+        std::cerr << "Unknown transition mode: " << transition << "\n";
+        return 1;
+    }
 
-    if (initialize_enclave() < 0) {
-        std::cerr << "Failed to initialize enclave\n";
+    std::vector<int> allocators;
+    if (allocator == "heap" || allocator == "both") allocators.push_back(ALLOCATOR_HEAP);
+    if (allocator.empty() || allocator == "arena" || allocator == "both") allocators.push_back(ALLOCATOR_ARENA);
+    if (allocators.empty()) {
+        std::cerr << "Unknown allocator: " << allocator << "\n";
         return 1;
     }
 
+    std::vector<std::string> variants;
+    if (enclave_variant == "all") {
+        variants = list_enclave_variants();
+        if (variants.empty()) {
+            std::cerr << "No enclave variants found; build them with 'make variants'\n";
+            return 1;
+        }
+    } else {
+        variants.push_back(enclave_variant);
+    }
+
+    if (dispatch != "runtime" && dispatch != "static") {
+        std::cerr << "Unknown dispatch mode: " << dispatch << "\n";
+        return 1;
+    }
+    set_static_dispatch(dispatch == "static");
+    if (!set_flush_strategy(flush_strategy)) {
+        std::cerr << "Unknown flush strategy: " << flush_strategy << "\n";
+        return 1;
+    }
+    if (!set_hardening(hardening)) {
+        std::cerr << "Unknown hardening mode: " << hardening << "\n";
+        return 1;
+    }
+    if (!set_barrier_stride(barrier_stride)) {
+        std::cerr << "Barrier stride must be 0 or a power of two: " << barrier_stride << "\n";
+        return 1;
+    }
+
+    parse_mitigations(mitigations);
+    print_config();
+    std::cout << "  Backend:              " << BenchmarkRunner::backend() << "\n";
+    std::cout << "  I/O backend:          " << io_backend::name() << "\n";
+    CycleCounter::calibrate();
+    print_timer_info();
+
     BenchmarkRunner runner;
-    runner.setup_environment();
+    runner.set_per_op_timing(per_op);
+    if (!runner.set_cache_state(cache_state)) {
+        std::cerr << "Unknown cache state: " << cache_state << "\n";
+        return 1;
+    }
+    print_cache_info(runner.cache_conditioner());
+    if (perf) {
+        runner.enable_perf_counters();
+    }
 
+    // Sealing keys derive from MRSIGNER, shared by every variant, so setup
+    // and the sweep matrix only need the first one
+    const std::string first_image = enclave_variant_path(variants.front());
     if (setup_files) {
+        if (initialize_enclave(nullptr, first_image) < 0) {
+            std::cerr << "Failed to initialize enclave " << first_image << "\n";
+            return 1;
+        }
+        runner.setup_environment();
         std::cout << "Creating sealed test files..." << std::endl;
         runner.create_sealed_test_file(filename);
         sgx_destroy_enclave(global_eid);
         return 0;
     }
 
+    if (!matrix_file.empty()) {
+        SweepMatrix matrix;
+        if (!load_sweep_matrix(matrix_file, matrix)) return 1;
+        if (variants.size() > 1) {
+            std::cerr << "--matrix runs one enclave; name a single --enclave-variant\n";
+            return 1;
+        }
+        if (allocators.size() > 1) {
+            std::cerr << "--matrix runs one allocator; name heap or arena\n";
+            return 1;
+        }
+        if (initialize_enclave(nullptr, first_image) < 0) {
+            std::cerr << "Failed to initialize enclave " << first_image << "\n";
+            return 1;
+        }
+        ecall_set_allocator(global_eid, allocators.front());
+        std::cout << "Allocator: " << allocator_name(allocators.front()) << std::endl;
+
+        std::cout << "Warming up CPU..." << std::endl;
+        int warmup_calls = RunController::warm_up_until_steady();
+        std::cout << "Warm-up steady after " << warmup_calls << " calls." << std::endl;
+
+        std::cout << "Sweep seed: " << matrix.seed << std::endl;
+        int status = run_sweep(runner, matrix, allocator_name(allocators.front()),
+                               output_file.empty() ? "sweep_results.csv" : output_file);
+        sgx_destroy_enclave(global_eid);
+        return status;
+    }
+
     if (test_type.empty()) {
         std::cerr << "Error: Test type required\n";
         print_usage(argv[0]);
-        sgx_destroy_enclave(global_eid);
         return 1;
     }
 
-    // Warm-up
-    std::cout << "Warming up CPU..." << std::endl;
-    for (int i = 0; i < 200; ++i) {
-         ecall_warmup(global_eid);
-    }
-    std::cout << "Warm-up complete. Starting benchmark." << std::endl;
-
-    BenchmarkResult result = {0.0, 0, 0.0};
-    if (test_type == "ecall") {
-        result = runner.benchmark_empty_ecall(iterations);
-    } else if (test_type == "pure_ocall") {
-        result = runner.benchmark_pure_ocall(iterations);
-    } else if (test_type == "pingpong") {
-        result = runner.benchmark_ping_pong(iterations);
-    } else if (test_type == "untrusted_file") {
-        result = runner.benchmark_file_read(filename, iterations);
-    } else if (test_type == "sealed_file") {
-        std::string sealed_filename = filename + ".sealed";
-        result = runner.benchmark_sgx_file_read(sealed_filename, iterations);
-    } else if (test_type == "crypto") {
-        result = runner.benchmark_crypto_workload(iterations);
-    } else {
-        std::cerr << "Unknown test type: " << test_type << "\n";
-        sgx_destroy_enclave(global_eid);
-        return 1;
+    // Startup creates and destroys its own enclaves, so it runs without one
+    if (test_type == "startup") {
+        std::vector<std::string> images = list_startup_images();
+        if (images.empty()) {
+            std::cout << "No startup images; measuring " << first_image
+                      << " only (build more with 'make startup-enclaves')" << std::endl;
+            images.push_back(first_image);
+        }
+        std::vector<StartupPoint> points = runner.benchmark_startup(images, iterations);
+        if (points.empty()) return 1;
+        print_startup_points(points);
+        if (!output_file.empty()) {
+            write_startup_csv(output_file, points);
+        }
+        return 0;
     }
 
-    double time_per_op = (result.time_ms * 1000.0) / iterations;
-    std::cout << "Results: " << result.time_ms << "ms total, " << time_per_op << "μs per operation, "
-              << result.cycles_per_op << " cycles per operation\n";
+    sgx_uswitchless_config_t switchless_config =
+        BenchmarkRunner::make_switchless_config(switchless_options);
 
-    if (!output_file.empty()) {
-        std::ofstream csv(output_file, std::ios::app);
-        csv << test_type << "," << mitigations << ","
-            << iterations << "," << result.time_ms << "," << time_per_op << ","
-            << result.cycles << "," << result.cycles_per_op << "\n";
+    struct RunConfig {
+        int allocator;
+        TransitionMode mode;
+        std::string variant;
+    };
+    std::vector<RunConfig> runs;
+    for (int alloc : allocators) {
+        for (TransitionMode mode : modes) {
+            for (const std::string& variant : variants) runs.push_back({alloc, mode, variant});
+        }
     }
 
-    sgx_destroy_enclave(global_eid);
+    // Each transition mode, allocator and enclave variant gets a fresh
+    // enclave so that idle switchless workers never perturb the classic
+    // measurements. Variants run back to back, and each is compared with
+    // the first one under the same mode and allocator.
+    double reference_cycles = 0.0;
+    for (const RunConfig& run : runs) {
+        TransitionMode mode = run.mode;
+        bool switchless = (mode == TransitionMode::Switchless);
+        const std::string image = enclave_variant_path(run.variant);
+        if (initialize_enclave(switchless ? &switchless_config : nullptr, image) < 0) {
+            std::cerr << "Failed to initialize enclave " << image << "\n";
+            return 1;
+        }
+        if (run.variant == variants.front()) reference_cycles = 0.0;
+        runner.setup_environment();
+        runner.set_transition_mode(mode);
+        ecall_set_allocator(global_eid, run.allocator);
+        std::cout << "Transition mode: " << transition_name(mode) << std::endl;
+        std::cout << "Allocator: " << allocator_name(run.allocator) << std::endl;
+        std::cout << "Enclave: " << image << std::endl;
+        std::string label =
+            allocator.empty() ? test_type : test_type + "_" + allocator_name(run.allocator);
+        if (!enclave_variant.empty()) label += "_" + run.variant;
+        if (cache_state != "warm") label += "_" + cache_state;
+
+        // Warm-up
+        std::cout << "Warming up CPU..." << std::endl;
+        int warmup_calls = RunController::warm_up_until_steady();
+        std::cout << "Warm-up steady after " << warmup_calls
+                  << " calls. Starting benchmark." << std::endl;
+        const bool tracing = !trace_file.empty() && start_trace();
+
+        if (test_type == "sealed_stream") {
+            std::vector<long long> chunk = parse_size_list(chunk_size);
+            if (chunk.size() != 1 || chunk[0] < SEALED_STREAM_MIN_CHUNK ||
+                chunk[0] > SEALED_STREAM_MAX_CHUNK) {
+                std::cerr << "Chunk size must be between " << SEALED_STREAM_MIN_CHUNK << " and "
+                          << SEALED_STREAM_MAX_CHUNK << " bytes\n";
+                sgx_destroy_enclave(global_eid);
+                return 1;
+            }
+            for (long long size : parse_size_list(sizes.empty() ? "64K,1M,16M,128M" : sizes)) {
+                if (size < 0) continue;
+                StreamResult result;
+                if (!runner.benchmark_sealed_stream(filename, static_cast<uint64_t>(size),
+                                                    static_cast<uint32_t>(chunk[0]), iterations,
+                                                    result)) {
+                    sgx_destroy_enclave(global_eid);
+                    return 1;
+                }
+                print_stream_result(result);
+                if (!output_file.empty()) {
+                    write_stream_csv(output_file, label, mitigations, result);
+                }
+            }
+        } else if (test_type == "zero_copy") {
+            std::vector<PayloadPoint> points = runner.benchmark_zero_copy(
+                filename, parse_size_list(sizes.empty() ? "64,1K,4K,8K,64K,256K,1M" : sizes),
+                iterations);
+            if (points.empty()) {
+                sgx_destroy_enclave(global_eid);
+                return 1;
+            }
+            print_payload_points(points);
+            if (!output_file.empty()) {
+                write_payload_csv(output_file, label, mitigations, iterations, points);
+            }
+        } else if (test_type == "marshal") {
+            std::vector<MarshalPoint> points = runner.benchmark_marshalling(
+                parse_size_list(sizes.empty() ? "0,64,256,1K,4K,16K,64K,256K,1M,4M" : sizes),
+                iterations);
+            print_marshal_points(points);
+            if (!output_file.empty()) {
+                write_marshal_csv(output_file, label, mitigations, points);
+            }
+        } else if (test_type == "working_set") {
+            // -i is the number of accesses per cell, at least 64K
+            uint64_t epc_bytes = detect_epc_bytes();
+            std::cout << "EPC size: " << (epc_bytes ? std::to_string(epc_bytes >> 20) + " MB"
+                                                    : std::string("unknown")) << std::endl;
+            std::vector<long long> set_sizes;
+            if (sizes.empty()) {
+                long long limit = epc_bytes ? static_cast<long long>(4 * epc_bytes) : (512LL << 20);
+                for (long long size = 64LL << 10; size <= limit; size *= 2) set_sizes.push_back(size);
+            } else {
+                set_sizes = parse_size_list(sizes);
+            }
+            uint64_t accesses = iterations < (1 << 16) ? (1 << 16) : static_cast<uint64_t>(iterations);
+            std::vector<WorkingSetPoint> points = runner.benchmark_working_set(set_sizes, accesses);
+            print_working_set(points, epc_bytes);
+            if (!output_file.empty()) {
+                write_working_set_csv(output_file, label, mitigations, points, epc_bytes);
+            }
+        } else if (test_type == "crypto_suite") {
+            std::vector<CryptoPoint> points = runner.benchmark_crypto_suite(
+                parse_size_list(sizes.empty() ? "64,256,1K,4K,16K,64K,256K,1M" : sizes), iterations);
+            if (points.empty()) {
+                sgx_destroy_enclave(global_eid);
+                return 1;
+            }
+            print_crypto_points(points);
+            if (!output_file.empty()) {
+                write_crypto_csv(output_file, label, mitigations, points);
+            }
+        } else if (test_type == "flush") {
+            std::vector<FlushPoint> points = runner.benchmark_flush(
+                parse_size_list(sizes.empty() ? "64,512,4K,32K,256K,1M" : sizes), iterations);
+            if (points.empty()) {
+                sgx_destroy_enclave(global_eid);
+                return 1;
+            }
+            print_flush_points(points);
+            if (!output_file.empty()) {
+                write_flush_csv(output_file, label, mitigations, points);
+            }
+        } else if (test_type == "memops") {
+            std::string selected;
+            std::vector<MemopsPoint> points = runner.benchmark_memops(
+                parse_size_list(sizes.empty() ? "64,256,1K,4K,16K,64K,256K,1M" : sizes), iterations,
+                selected);
+            if (points.empty()) {
+                sgx_destroy_enclave(global_eid);
+                return 1;
+            }
+            std::cout << "Constant-time copy/zero in use: " << selected << std::endl;
+            print_memops_points(points);
+            if (!output_file.empty()) {
+                write_memops_csv(output_file, label, mitigations, points);
+            }
+        } else if (test_type == "hardening") {
+            std::vector<HardeningPoint> points = runner.benchmark_hardening(filename, iterations);
+            print_hardening_points(points);
+            if (!output_file.empty()) {
+                for (const HardeningPoint& point : points) {
+                    write_result_csv(output_file, label + "_" + point.test + "_" + point.placement,
+                                     mitigations, iterations, point.result, mode);
+                }
+            }
+        } else if (test_type == "seal_key") {
+            std::vector<SealKeyPoint> points = runner.benchmark_seal_key(filename, iterations);
+            print_seal_key_points(points);
+            if (!output_file.empty()) {
+                for (const SealKeyPoint& point : points) {
+                    write_result_csv(output_file, label + "_" + point.path, mitigations, iterations,
+                                     point.result, mode);
+                }
+            }
+        } else if (!batch_sizes.empty()) {
+            std::vector<long long> batch_list;
+            if (batch_sizes == "sweep") {
+                for (long long size = 1; size <= 4096; size *= 2) batch_list.push_back(size);
+            } else {
+                batch_list = parse_size_list(batch_sizes);
+            }
+            for (long long size : batch_list) {
+                if (size < 1) continue;
+                int batch_size = static_cast<int>(size);
+                BenchmarkResult result =
+                    runner.benchmark_batch(test_type, filename, iterations, batch_size);
+                std::cout << "Batch size " << batch_size << ": ";
+                print_result(result, iterations, per_op);
+                if (!output_file.empty()) {
+                    write_batch_csv(output_file, label, mitigations, iterations,
+                                    batch_size, result);
+                }
+            }
+        } else if (repetitions > 0) {
+            RunController controller(runner, repetitions);
+            RepeatedResult baseline, candidate;
+            if (!controller.compare(test_type, filename, iterations, "none", mitigations,
+                                    baseline, candidate)) {
+                std::cerr << "Unknown test type: " << test_type << "\n";
+                sgx_destroy_enclave(global_eid);
+                return 1;
+            }
+            OverheadEstimate estimate = bootstrap_overhead(baseline.kept, candidate.kept);
+            print_overhead(mitigations, baseline, candidate, estimate);
+            // The 'none' runs isolate the compiler mitigations
+            if (run.variant == variants.front()) reference_cycles = baseline.mean;
+            print_variant_overhead(run.variant, variants.front(), baseline.mean, reference_cycles);
+            if (!output_file.empty()) {
+                write_overhead_csv(output_file, label, mitigations, iterations,
+                                   baseline, candidate, estimate, mode);
+            }
+        } else if (threads > 0) {
+            std::vector<ScalingPoint> curve =
+                runner.benchmark_thread_scaling(test_type, filename, iterations, threads);
+            if (curve.empty()) {
+                sgx_destroy_enclave(global_eid);
+                return 1;
+            }
+            print_scaling(curve);
+            if (!output_file.empty()) {
+                write_scaling_csv(output_file, label, mitigations, iterations, curve, mode);
+            }
+        } else {
+            BenchmarkResult result = {0.0, 0, 0.0, LatencyStats()};
+            if (!runner.run_test(test_type, filename, iterations, result)) {
+                std::cerr << "Unknown test type: " << test_type << "\n";
+                sgx_destroy_enclave(global_eid);
+                return 1;
+            }
+            print_result(result, iterations, per_op);
+            if (run.variant == variants.front()) reference_cycles = result.cycles_per_op;
+            print_variant_overhead(run.variant, variants.front(), result.cycles_per_op,
+                                   reference_cycles);
+            if (!output_file.empty()) {
+                write_result_csv(output_file, label, mitigations, iterations, result, mode);
+            }
+        }
+
+        if (tracing) {
+            finish_trace(runs.size() == 1 ? trace_file
+                                          : trace_path(trace_file, label + "_" + transition_name(mode)));
+        }
+        sgx_destroy_enclave(global_eid);
+    }
     return 0;
 }
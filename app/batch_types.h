@@ -0,0 +1,33 @@
+// app/batch_types.h - Request/result descriptors shared by the batched ECALL/OCALL API
+#ifndef BATCH_TYPES_H
+#define BATCH_TYPES_H
+
+#include <stdint.h>
+
+#define BATCH_MAX_FILENAME 256
+#define BATCH_FILE_SLOT_SIZE 8192
+// Upper bound on file reads per batched OCALL; keeps the marshalled
+// buffer (BATCH_OCALL_MAX_FILES * slot size) well inside the untrusted stack
+#define BATCH_OCALL_MAX_FILES 64
+
+#define BATCH_OP_EMPTY 0
+#define BATCH_OP_PING 1
+#define BATCH_OP_FILE_READ 2
+#define BATCH_OP_CRYPTO 3
+
+#define BATCH_STATUS_OK 0
+#define BATCH_STATUS_BAD_OP 1
+#define BATCH_STATUS_IO_ERROR 2
+
+typedef struct {
+    uint32_t op;
+    int32_t arg;
+    char filename[BATCH_MAX_FILENAME];
+} batch_request_t;
+
+typedef struct {
+    uint32_t status;
+    uint32_t value;     // checksum for file reads, echoed arg for pings
+} batch_result_t;
+
+#endif // BATCH_TYPES_H
@@ -3,186 +3,1112 @@
 #include "cycle_counter.h"
 #include "enclave_u.h"
 #include "mitigation_config.h"
+#include "batch_types.h"
+#include "sealed_stream_format.h"
+#include "file_ring.h"
+#include "file_ring_types.h"
+#include "marshal_types.h"
+#include "working_set_types.h"
+#include "session_seal_format.h"
+#include "crypto_suite_types.h"
+#include "memops_types.h"
+#include "flush_types.h"
+#include "config_parser.h"
+#include "enclave_pool.h"
+#include "io_backend.h"
+#include <atomic>
 #include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
 #include <iostream>
+#include <memory>
+#include <thread>
+#include <pthread.h>
+#include <sched.h>
 
 extern sgx_enclave_id_t global_eid;
 extern MitigationConfig g_app_config;
+extern LatencyHistogram* g_ocall_histogram;
+extern uint64_t g_last_ocall_cycles;
 
-void BenchmarkRunner::flush_caches() {
-    const size_t cache_flush_size = 32 * 1024 * 1024;
-    volatile char* flush_buffer = new char[cache_flush_size];
-
-    for (size_t i = 0; i < cache_flush_size; i += 64) {
-        flush_buffer[i] = static_cast<char>(i & 0xFF);
-    }
-
-    volatile int sum = 0;
-    for (size_t i = 0; i < cache_flush_size; i += 64) {
-        sum += flush_buffer[i];
+// Plaintext of the sealed test files (just under 1 KB)
+static std::string sealed_test_data() {
+    std::string test_data = "This is test data for SGX sealing benchmark. ";
+    for (int i = 0; i < 50; i++) {
+        test_data += "More test data " + std::to_string(i) + ". ";
     }
-
-    delete[] flush_buffer;
-    __asm__ volatile ("mfence" ::: "memory");
+    return test_data;
 }
 
 void BenchmarkRunner::setup_environment() {
     ecall_set_mitigation_config(global_eid, &g_app_config);
 }
 
-BenchmarkResult BenchmarkRunner::benchmark_empty_ecall(int iterations) {
-    flush_caches();
+bool BenchmarkRunner::enable_perf_counters() {
+    collect_perf = perf_counters.open();
+    return collect_perf;
+}
 
-    uint64_t start_cycles = CycleCounter::get_cycles();
-    auto start_time = std::chrono::high_resolution_clock::now();
+sgx_uswitchless_config_t BenchmarkRunner::make_switchless_config(const SwitchlessOptions& options) {
+    sgx_uswitchless_config_t config = SGX_USWITCHLESS_CONFIG_INITIALIZER;
+    config.num_uworkers = options.untrusted_workers;
+    config.num_tworkers = options.trusted_workers;
+    config.retries_before_fallback = options.retries_before_fallback;
+    config.retries_before_sleep = options.retries_before_sleep;
+    return config;
+}
 
-    for (int i = 0; i < iterations; i++) {
-        ecall_empty(global_eid);
+// Dispatches a test type name to its benchmark. Returns false for unknown names.
+bool BenchmarkRunner::run_test(const std::string& test_type, const std::string& filename,
+                               int iterations, BenchmarkResult& result) {
+    if (test_type == "ecall") {
+        result = benchmark_empty_ecall(iterations);
+    } else if (test_type == "pure_ocall") {
+        result = benchmark_pure_ocall(iterations);
+    } else if (test_type == "pingpong") {
+        result = benchmark_ping_pong(iterations);
+    } else if (test_type == "untrusted_file") {
+        result = benchmark_file_read(filename, iterations);
+    } else if (test_type == "sealed_file") {
+        result = benchmark_sgx_file_read(filename + ".sealed", iterations);
+    } else if (test_type == "crypto") {
+        result = benchmark_crypto_workload(iterations);
+    } else if (test_type == "alloc") {
+        result = benchmark_alloc(iterations);
+    } else if (test_type == "sealed_cached") {
+        result = benchmark_session_file_read(filename, iterations, SESSION_UNSEAL_CACHED);
+    } else if (test_type == "sealed_derive") {
+        result = benchmark_session_file_read(filename, iterations, SESSION_UNSEAL_DERIVE);
+    } else {
+        return false;
     }
+    return true;
+}
 
-    auto end_time = std::chrono::high_resolution_clock::now();
-    uint64_t end_cycles = CycleCounter::get_cycles();
+// Runs op(i) for every iteration, timing the whole loop and, when per-op
+// timing is enabled, each individual call into the latency histogram.
+// With a cold cache state every call is conditioned and timed on its own,
+// and the total is the sum of the calls: conditioning stays out of the
+// cycles, the wall time and the perf counts.
+template <typename Operation>
+BenchmarkResult BenchmarkRunner::time_loop(int iterations, Operation op) {
+    histogram.reset();
+    uint64_t total_cycles = 0;
+    double time_ms = 0.0;
 
-    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time);
-    uint64_t total_cycles = end_cycles - start_cycles;
+    if (cache.per_operation()) {
+        for (int i = 0; i < iterations; i++) {
+            cache.condition();
+            if (collect_perf) {
+                if (i == 0) perf_counters.enable();
+                else perf_counters.resume();
+            }
+            uint64_t op_start = CycleCounter::start();
+            op(i);
+            uint64_t op_cycles = CycleCounter::elapsed_since(op_start);
+            if (collect_perf) perf_counters.disable();
 
-    return {
-        static_cast<double>(duration.count()) / 1000.0,
+            total_cycles += op_cycles;
+            if (per_op_timing) histogram.record(op_cycles);
+        }
+        time_ms = CycleCounter::cycles_to_ns(static_cast<double>(total_cycles)) / 1e6;
+    } else {
+        if (collect_perf) perf_counters.enable();
+
+        auto start_time = std::chrono::high_resolution_clock::now();
+        uint64_t start_cycles = CycleCounter::start();
+
+        if (per_op_timing) {
+            for (int i = 0; i < iterations; i++) {
+                uint64_t op_start = CycleCounter::start();
+                op(i);
+                histogram.record(CycleCounter::elapsed_since(op_start));
+            }
+        } else {
+            for (int i = 0; i < iterations; i++) {
+                op(i);
+            }
+        }
+
+        total_cycles = CycleCounter::elapsed_since(start_cycles);
+        auto end_time = std::chrono::high_resolution_clock::now();
+        if (collect_perf) perf_counters.disable();
+
+        auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time);
+        time_ms = static_cast<double>(duration.count()) / 1000.0;
+    }
+
+    BenchmarkResult result = {
+        time_ms,
         total_cycles,
-        static_cast<double>(total_cycles) / iterations
+        static_cast<double>(total_cycles) / iterations,
+        LatencyStats()
     };
+    if (per_op_timing) {
+        result.latency = histogram.stats();
+    }
+    if (collect_perf) {
+        result.perf = perf_counters.read(static_cast<uint64_t>(iterations));
+    }
+    return result;
 }
 
-BenchmarkResult BenchmarkRunner::benchmark_pure_ocall(int iterations) {
-    flush_caches();
+BenchmarkResult BenchmarkRunner::benchmark_empty_ecall(int iterations) {
+    if (transition == TransitionMode::Switchless) {
+        return time_loop(iterations, [](int) {
+            ecall_empty_switchless(global_eid);
+        });
+    }
+    return time_loop(iterations, [](int) {
+        ecall_empty(global_eid);
+    });
+}
 
+BenchmarkResult BenchmarkRunner::benchmark_pure_ocall(int iterations) {
     sgx_status_t ret = ecall_setup_ocall_benchmark(global_eid);
     if (ret != SGX_SUCCESS) {
         std::cerr << "Failed to setup OCALL benchmark" << std::endl;
-        return {0.0, 0, 0.0};
+        return {0.0, 0, 0.0, LatencyStats()};
+    }
+
+    // All OCALLs happen inside a single ECALL, so per-op latencies are
+    // sampled by the OCALL handler as the gap between consecutive calls.
+    histogram.reset();
+    if (per_op_timing) {
+        g_last_ocall_cycles = 0;
+        g_ocall_histogram = &histogram;
     }
+    cache.condition();
+    if (collect_perf) perf_counters.enable();
 
-    uint64_t start_cycles = CycleCounter::get_cycles();
     auto start_time = std::chrono::high_resolution_clock::now();
+    uint64_t start_cycles = CycleCounter::start();
 
-    ret = ecall_measure_pure_ocall(global_eid, iterations);
+    if (transition == TransitionMode::Switchless) {
+        ret = ecall_measure_pure_ocall_switchless(global_eid, iterations);
+    } else {
+        ret = ecall_measure_pure_ocall(global_eid, iterations);
+    }
 
+    uint64_t total_cycles = CycleCounter::elapsed_since(start_cycles);
     auto end_time = std::chrono::high_resolution_clock::now();
-    uint64_t end_cycles = CycleCounter::get_cycles();
+    if (collect_perf) perf_counters.disable();
+
+    g_ocall_histogram = nullptr;
 
     if (ret != SGX_SUCCESS) {
         std::cerr << "OCALL benchmark failed" << std::endl;
-        return {0.0, 0, 0.0};
+        return {0.0, 0, 0.0, LatencyStats()};
     }
 
     auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time);
-    uint64_t total_cycles = end_cycles - start_cycles;
 
-    return {
+    BenchmarkResult result = {
         static_cast<double>(duration.count()) / 1000.0,
         total_cycles,
-        static_cast<double>(total_cycles) / iterations
+        static_cast<double>(total_cycles) / iterations,
+        LatencyStats()
     };
+    if (per_op_timing) {
+        result.latency = histogram.stats();
+    }
+    if (collect_perf) {
+        result.perf = perf_counters.read(static_cast<uint64_t>(iterations));
+    }
+    return result;
 }
 
 BenchmarkResult BenchmarkRunner::benchmark_ping_pong(int iterations) {
-    flush_caches();
+    if (transition == TransitionMode::Switchless) {
+        return time_loop(iterations, [](int i) {
+            ecall_ping_switchless(global_eid, i);
+        });
+    }
+    return time_loop(iterations, [](int i) {
+        ecall_ping(global_eid, i);
+    });
+}
 
-    uint64_t start_cycles = CycleCounter::get_cycles();
-    auto start_time = std::chrono::high_resolution_clock::now();
+BenchmarkResult BenchmarkRunner::benchmark_file_read(const std::string& filename, int iterations) {
+    const char* name = filename.c_str();
+    if (transition == TransitionMode::Switchless) {
+        return time_loop(iterations, [name](int) {
+            ecall_file_read_switchless(global_eid, name);
+        });
+    }
+    return time_loop(iterations, [name](int) {
+        ecall_file_read(global_eid, name);
+    });
+}
 
-    for (int i = 0; i < iterations; i++) {
-        ecall_ping(global_eid, i);
+BenchmarkResult BenchmarkRunner::benchmark_sgx_file_read(const std::string& filename, int iterations) {
+    const char* name = filename.c_str();
+    return time_loop(iterations, [name](int) {
+        ecall_sgx_file_read(global_eid, name);
+    });
+}
+
+BenchmarkResult BenchmarkRunner::benchmark_crypto_workload(int iterations) {
+    return time_loop(iterations, [](int) {
+        ecall_crypto_workload(global_eid);
+    });
+}
+
+// Seals filename's test data under the current session key as
+// filename.session. Must run in the enclave that will read it back.
+bool BenchmarkRunner::prepare_session_file(const std::string& filename) {
+    std::string data = sealed_test_data();
+    std::string session_filename = filename + ".session";
+    int status = -1;
+    sgx_status_t ret = ecall_session_seal_file(global_eid, &status, session_filename.c_str(),
+                                               reinterpret_cast<const uint8_t*>(data.data()),
+                                               data.size());
+    if (ret != SGX_SUCCESS || status != SESSION_SEAL_OK) {
+        std::cerr << "Session seal failed (sgx " << ret << ", status " << status << ")" << std::endl;
+        return false;
     }
+    return true;
+}
 
-    auto end_time = std::chrono::high_resolution_clock::now();
-    uint64_t end_cycles = CycleCounter::get_cycles();
+// Direct AES-GCM reads of filename.session, with the key either cached in
+// the enclave or derived with EGETKEY on every call
+BenchmarkResult BenchmarkRunner::benchmark_session_file_read(const std::string& filename,
+                                                             int iterations, int mode) {
+    BenchmarkResult result = {0.0, 0, 0.0, LatencyStats()};
+    if (!prepare_session_file(filename)) return result;
 
-    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time);
-    uint64_t total_cycles = end_cycles - start_cycles;
+    std::string session_filename = filename + ".session";
+    const char* name = session_filename.c_str();
+    int status = -1;
+    if (ecall_session_unseal_file(global_eid, &status, name, mode) != SGX_SUCCESS ||
+        status != SESSION_SEAL_OK) {
+        std::cerr << "Session unseal failed with status " << status << std::endl;
+        return result;
+    }
 
-    return {
-        static_cast<double>(duration.count()) / 1000.0,
-        total_cycles,
-        static_cast<double>(total_cycles) / iterations
+    return time_loop(iterations, [name, mode](int) {
+        int unused = 0;
+        ecall_session_unseal_file(global_eid, &unused, name, mode);
+    });
+}
+
+// Side-by-side cost of reading one sealed test record: sgx_unseal_data
+// (EGETKEY + checks + AES-GCM), direct AES-GCM after EGETKEY, and direct
+// AES-GCM with the cached key. The difference between the last two is the
+// key derivation; "rotate" is the cost of ecall_session_key_rotate.
+std::vector<SealKeyPoint> BenchmarkRunner::benchmark_seal_key(const std::string& filename,
+                                                              int iterations) {
+    std::vector<SealKeyPoint> points;
+
+    std::string sealed_filename = filename + ".sealed";
+    std::string data = sealed_test_data();
+    ecall_create_sealed_file(global_eid, sealed_filename.c_str(), data.c_str(), data.length());
+    points.push_back({"unseal_data", benchmark_sgx_file_read(sealed_filename, iterations)});
+    points.push_back({"derive", benchmark_session_file_read(filename, iterations, SESSION_UNSEAL_DERIVE)});
+    points.push_back({"cached", benchmark_session_file_read(filename, iterations, SESSION_UNSEAL_CACHED)});
+
+    // Rotating invalidates filename.session, so it goes last and the file
+    // is resealed under the final key afterwards
+    points.push_back({"rotate", time_loop(iterations, [](int) {
+        int status = 0;
+        uint32_t generation = 0;
+        ecall_session_key_rotate(global_eid, &status, &generation);
+    })});
+    prepare_session_file(filename);
+    return points;
+}
+
+// Reads heap, stack and TCS count back from a startup image name,
+// startup/h<heap>_s<stack>_t<tcs>.signed.so; fields not present stay 0
+static void parse_startup_image(const std::string& image, StartupPoint& point) {
+    std::string name = image.substr(image.find_last_of('/') + 1);
+    name = name.substr(0, name.find('.'));
+    std::string remaining = name + "_";
+    size_t pos = 0;
+    while ((pos = remaining.find('_')) != std::string::npos) {
+        std::string field = remaining.substr(0, pos);
+        remaining.erase(0, pos + 1);
+        if (field.size() < 2 || field[1] < '0' || field[1] > '9') continue;
+        std::vector<long long> value = parse_size_list(field.substr(1));
+        if (value.size() != 1) continue;
+        if (field[0] == 'h') point.heap_bytes = value[0];
+        else if (field[0] == 's') point.stack_bytes = value[0];
+        else if (field[0] == 't') point.tcs = static_cast<int>(value[0]);
+    }
+}
+
+// Enclave load and teardown per image: create, first ECALL and destroy,
+// each timed on its own, then the same first ECALL on an enclave borrowed
+// from a warm EnclavePool. Creation takes milliseconds for large heaps, so
+// at most 100 runs per image are made.
+std::vector<StartupPoint> BenchmarkRunner::benchmark_startup(const std::vector<std::string>& images,
+                                                             int iterations) {
+    const int runs = iterations < 1 ? 1 : (iterations > 100 ? 100 : iterations);
+    std::vector<StartupPoint> points;
+
+    for (const std::string& image : images) {
+        StartupPoint point;
+        point.image = image;
+        point.heap_bytes = 0;
+        point.stack_bytes = 0;
+        point.tcs = 0;
+        point.runs = runs;
+        parse_startup_image(image, point);
+
+        // Untimed load brings the image into the page cache
+        sgx_enclave_id_t eid = 0;
+        if (create_enclave(image, nullptr, &eid) != SGX_SUCCESS) {
+            std::cerr << "Failed to create enclave from " << image << std::endl;
+            continue;
+        }
+        sgx_destroy_enclave(eid);
+
+        LatencyHistogram create_histogram, ecall_histogram, destroy_histogram;
+        bool failed = false;
+        for (int i = 0; i < runs && !failed; i++) {
+            uint64_t start_cycles = CycleCounter::start();
+            failed = create_enclave(image, nullptr, &eid) != SGX_SUCCESS;
+            create_histogram.record(CycleCounter::elapsed_since(start_cycles));
+            if (failed) break;
+
+            start_cycles = CycleCounter::start();
+            ecall_warmup(eid);
+            ecall_histogram.record(CycleCounter::elapsed_since(start_cycles));
+
+            start_cycles = CycleCounter::start();
+            sgx_destroy_enclave(eid);
+            destroy_histogram.record(CycleCounter::elapsed_since(start_cycles));
+        }
+        if (failed) {
+            std::cerr << "Enclave creation failed during the run for " << image << std::endl;
+            continue;
+        }
+        point.create = create_histogram.stats();
+        point.first_ecall = ecall_histogram.stats();
+        point.destroy = destroy_histogram.stats();
+
+        EnclavePool pool(image, 1);
+        if (!pool.prewarm(1)) {
+            std::cerr << "Failed to prewarm an enclave pool for " << image << std::endl;
+            continue;
+        }
+        uint64_t start_cycles = CycleCounter::start();
+        for (int i = 0; i < runs; i++) {
+            EnclavePool::Lease lease(pool);
+            ecall_warmup(lease.eid());
+        }
+        point.pooled_cycles = static_cast<double>(CycleCounter::elapsed_since(start_cycles)) / runs;
+        points.push_back(point);
+    }
+    return points;
+}
+
+// Speculation hardening placements on the loops that checksum OCALL data
+// (untrusted_file, sealed_file) and on one with fixed bounds (crypto):
+// lfence at several loop strides, at ECALL entry only (stride 0, the
+// unprotected floor) and index masking. The lfence mitigation is forced
+// on for the sweep; the rest of the -m set is kept.
+std::vector<HardeningPoint> BenchmarkRunner::benchmark_hardening(const std::string& filename,
+                                                                 int iterations) {
+    struct Placement {
+        const char* name;
+        int hardening;
+        uint32_t stride;
+    };
+    static const Placement placements[] = {
+        {"lfence16", HARDENING_LFENCE, 16},
+        {"lfence64", HARDENING_LFENCE, 64},
+        {"lfence256", HARDENING_LFENCE, 256},
+        {"lfence1024", HARDENING_LFENCE, 1024},
+        {"entry", HARDENING_LFENCE, 0},
+        {"mask", HARDENING_MASK, HARDENING_DEFAULT_STRIDE},
     };
+    static const char* const tests[] = { "untrusted_file", "sealed_file", "crypto" };
+
+    std::string data = sealed_test_data();
+    ecall_create_sealed_file(global_eid, (filename + ".sealed").c_str(), data.c_str(), data.length());
+
+    const MitigationConfig saved = g_app_config;
+    std::vector<HardeningPoint> points;
+    for (const Placement& placement : placements) {
+        g_app_config.lfence_barrier = true;
+        g_app_config.hardening = placement.hardening;
+        g_app_config.barrier_stride = placement.stride;
+        setup_environment();
+
+        for (const char* test : tests) {
+            HardeningPoint point;
+            point.test = test;
+            point.placement = placement.name;
+            run_test(test, filename, iterations, point.result);
+            points.push_back(point);
+        }
+    }
+    g_app_config = saved;
+    setup_environment();
+    return points;
 }
 
-BenchmarkResult BenchmarkRunner::benchmark_file_read(const std::string& filename, int iterations) {
-    flush_caches();
+// Per-call buffer churn; which allocator serves it is set with
+// ecall_set_allocator before the run
+BenchmarkResult BenchmarkRunner::benchmark_alloc(int iterations) {
+    return time_loop(iterations, [](int) {
+        ecall_alloc_workload(global_eid);
+    });
+}
 
-    uint64_t start_cycles = CycleCounter::get_cycles();
-    auto start_time = std::chrono::high_resolution_clock::now();
+// Issues ceil(iterations / batch_size) ecall_batch calls of batch_size
+// requests each. Cycle figures are per request; latency stats, when
+// enabled, describe whole batch calls.
+BenchmarkResult BenchmarkRunner::benchmark_batch(const std::string& test_type,
+                                                 const std::string& filename,
+                                                 int iterations, int batch_size) {
+    uint32_t op;
+    if (test_type == "ecall") op = BATCH_OP_EMPTY;
+    else if (test_type == "pingpong") op = BATCH_OP_PING;
+    else if (test_type == "untrusted_file") op = BATCH_OP_FILE_READ;
+    else if (test_type == "crypto") op = BATCH_OP_CRYPTO;
+    else {
+        std::cerr << "Test type '" << test_type << "' has no batched form" << std::endl;
+        return {0.0, 0, 0.0, LatencyStats()};
+    }
+    if (filename.size() >= BATCH_MAX_FILENAME) {
+        std::cerr << "Filename too long for batched requests" << std::endl;
+        return {0.0, 0, 0.0, LatencyStats()};
+    }
+
+    const size_t n = static_cast<size_t>(batch_size);
+    std::vector<batch_request_t> requests(n);
+    std::vector<batch_result_t> results(n);
+    for (size_t i = 0; i < n; i++) {
+        memset(&requests[i], 0, sizeof(batch_request_t));
+        requests[i].op = op;
+        requests[i].arg = static_cast<int32_t>(i);
+        memcpy(requests[i].filename, filename.c_str(), filename.size());
+    }
+
+    int batches = (iterations + batch_size - 1) / batch_size;
+    BenchmarkResult result = time_loop(batches, [&](int) {
+        ecall_batch(global_eid, requests.data(), results.data(), n);
+    });
+
+    double total_ops = static_cast<double>(batches) * batch_size;
+    result.cycles_per_op = static_cast<double>(result.cycles) / total_ops;
+    for (int event = 0; event < PERF_EVENT_COUNT; event++) {
+        result.perf.per_op[event] /= batch_size;
+    }
+    for (const batch_result_t& r : results) {
+        if (r.status != BATCH_STATUS_OK) {
+            std::cerr << "Batched request failed with status " << r.status << std::endl;
+            break;
+        }
+    }
+    return result;
+}
+
+std::function<sgx_status_t(int)> BenchmarkRunner::make_operation(const std::string& test_type,
+                                                                 const std::string& filename) {
+    const bool switchless = (transition == TransitionMode::Switchless);
+    if (test_type == "ecall") {
+        if (switchless) return [](int) { return ecall_empty_switchless(global_eid); };
+        return [](int) { return ecall_empty(global_eid); };
+    } else if (test_type == "pingpong") {
+        if (switchless) return [](int i) { return ecall_ping_switchless(global_eid, i); };
+        return [](int i) { return ecall_ping(global_eid, i); };
+    } else if (test_type == "untrusted_file") {
+        if (switchless) {
+            return [filename](int) { return ecall_file_read_switchless(global_eid, filename.c_str()); };
+        }
+        return [filename](int) { return ecall_file_read(global_eid, filename.c_str()); };
+    } else if (test_type == "sealed_file") {
+        std::string sealed_filename = filename + ".sealed";
+        return [sealed_filename](int) { return ecall_sgx_file_read(global_eid, sealed_filename.c_str()); };
+    } else if (test_type == "crypto") {
+        return [](int) { return ecall_crypto_workload(global_eid); };
+    } else if (test_type == "alloc") {
+        return [](int) { return ecall_alloc_workload(global_eid); };
+    } else if (test_type == "sealed_cached" || test_type == "sealed_derive") {
+        if (!prepare_session_file(filename)) return nullptr;
+        std::string session_filename = filename + ".session";
+        int mode = test_type == "sealed_cached" ? SESSION_UNSEAL_CACHED : SESSION_UNSEAL_DERIVE;
+        return [session_filename, mode](int) {
+            int status = 0;
+            return ecall_session_unseal_file(global_eid, &status, session_filename.c_str(), mode);
+        };
+    }
+    return nullptr;
+}
+
+static int pin_current_thread(int index) {
+    unsigned int cpus = std::thread::hardware_concurrency();
+    if (cpus == 0) return -1;
+
+    int cpu = index % static_cast<int>(cpus);
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0) return -1;
+    return cpu;
+}
+
+// Starts `threads` pinned workers that each run `iterations` operations
+// against the shared enclave. Workers spin on a start flag so that all of
+// them enter the timed region together.
+ScalingPoint BenchmarkRunner::run_threads(const std::function<sgx_status_t(int)>& op,
+                                          int iterations, int threads) {
+    std::vector<ThreadResult> results(static_cast<size_t>(threads));
+    std::unique_ptr<LatencyHistogram[]> histograms(new LatencyHistogram[threads]);
+    std::atomic<int> ready(0);
+    std::atomic<bool> go(false);
+    const bool time_each = per_op_timing;
+
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&, t]() {
+            int cpu = pin_current_thread(t);
+            LatencyHistogram& hist = histograms[t];
+            int failed = 0;
+
+            ready.fetch_add(1);
+            while (!go.load(std::memory_order_acquire)) {
+                __asm__ volatile ("pause");
+            }
 
-    for (int i = 0; i < iterations; i++) {
-        ecall_file_read(global_eid, filename.c_str());
+            uint64_t start_cycles = CycleCounter::start();
+            for (int i = 0; i < iterations; i++) {
+                if (time_each) {
+                    uint64_t op_start = CycleCounter::start();
+                    if (op(i) != SGX_SUCCESS) failed++;
+                    hist.record(CycleCounter::elapsed_since(op_start));
+                } else if (op(i) != SGX_SUCCESS) {
+                    failed++;
+                }
+            }
+            uint64_t total_cycles = CycleCounter::elapsed_since(start_cycles);
+
+            results[static_cast<size_t>(t)] = {
+                t, cpu, total_cycles,
+                static_cast<double>(total_cycles) / iterations,
+                failed,
+                time_each ? hist.stats() : LatencyStats()
+            };
+        });
     }
 
+    while (ready.load() < threads) {
+        std::this_thread::yield();
+    }
+    auto start_time = std::chrono::high_resolution_clock::now();
+    go.store(true, std::memory_order_release);
+
+    for (auto& worker : workers) {
+        worker.join();
+    }
     auto end_time = std::chrono::high_resolution_clock::now();
-    uint64_t end_cycles = CycleCounter::get_cycles();
 
     auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time);
-    uint64_t total_cycles = end_cycles - start_cycles;
+    double wall_ms = static_cast<double>(duration.count()) / 1000.0;
+    double total_ops = static_cast<double>(iterations) * threads;
 
     return {
-        static_cast<double>(duration.count()) / 1000.0,
-        total_cycles,
-        static_cast<double>(total_cycles) / iterations
+        threads,
+        wall_ms,
+        wall_ms > 0.0 ? total_ops / (wall_ms / 1000.0) : 0.0,
+        results
     };
 }
 
-BenchmarkResult BenchmarkRunner::benchmark_sgx_file_read(const std::string& filename, int iterations) {
-    flush_caches();
+std::vector<ScalingPoint> BenchmarkRunner::benchmark_thread_scaling(const std::string& test_type,
+                                                                    const std::string& filename,
+                                                                    int iterations, int max_threads) {
+    std::vector<ScalingPoint> curve;
+    std::function<sgx_status_t(int)> op = make_operation(test_type, filename);
+    if (!op) {
+        std::cerr << "Test type '" << test_type << "' cannot run multi-threaded" << std::endl;
+        return curve;
+    }
 
-    uint64_t start_cycles = CycleCounter::get_cycles();
-    auto start_time = std::chrono::high_resolution_clock::now();
+    for (int threads = 1; threads <= max_threads; threads++) {
+        cache.condition();
+        curve.push_back(run_threads(op, iterations, threads));
+    }
+    return curve;
+}
+
+// Bytes of traffic each cell of a size sweep is held to
+static const long long SWEEP_TRAFFIC_BUDGET = 256LL << 20;
+
+// Operations a sweep cell of `bytes` per operation runs: `requested`, cut
+// down to stay near SWEEP_TRAFFIC_BUDGET but never below `minimum`
+static uint64_t ops_within_budget(long long bytes, uint64_t requested, uint64_t minimum = 10) {
+    if (bytes <= 0) return requested;
+    uint64_t budget_ops = static_cast<uint64_t>(SWEEP_TRAFFIC_BUDGET / bytes);
+    if (budget_ops >= requested) return requested;
+    return budget_ops > minimum ? budget_ops : minimum;
+}
+
+static bool write_random_file(const std::string& path, uint64_t plain_size) {
+    io_backend::forget(path.c_str());
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) return false;
 
-    for (int i = 0; i < iterations; i++) {
-        ecall_sgx_file_read(global_eid, filename.c_str());
+    std::vector<char> block(1 << 20);
+    uint64_t state = 0x9E3779B97F4A7C15ULL;
+    for (uint64_t written = 0; written < plain_size; written += block.size()) {
+        for (char& c : block) {
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            c = static_cast<char>(state);
+        }
+        uint64_t n = plain_size - written;
+        if (n > block.size()) n = block.size();
+        file.write(block.data(), static_cast<std::streamsize>(n));
     }
+    return static_cast<bool>(file);
+}
+
+// Seals a plain_size-byte file into the chunked format and unseals it
+// again, timing each direction separately. Small files run several passes,
+// up to max_passes or about 256 MB of traffic, whichever comes first.
+// MB/s uses 10^6 bytes.
+bool BenchmarkRunner::benchmark_sealed_stream(const std::string& filename, uint64_t plain_size,
+                                              uint32_t chunk_size, int max_passes,
+                                              StreamResult& result) {
+    result = StreamResult();
+    result.plain_bytes = plain_size;
+    result.chunk_size = chunk_size;
+
+    std::string plain_path = filename + ".stream";
+    std::string sealed_path = filename + ".stream.sealed";
+    if (!write_random_file(plain_path, plain_size)) {
+        std::cerr << "Failed to write " << plain_path << "\n";
+        return false;
+    }
+
+    const int passes = static_cast<int>(ops_within_budget(static_cast<long long>(plain_size),
+                                                          max_passes > 0 ? max_passes : 1, 1));
+
+    uint64_t seal_cycles = 0, unseal_cycles = 0;
+    bool ok = true;
+    result.verified = true;
+    for (int pass = 0; pass < passes && ok; pass++) {
+        int seal_status = -1, unseal_status = -1;
+        uint64_t sealed_bytes = 0, unsealed_bytes = 0;
+        uint32_t sealed_sum = 0, unsealed_sum = 0;
 
+        cache.condition();
+        uint64_t begin = CycleCounter::start();
+        sgx_status_t ret = ecall_stream_seal_file(global_eid, &seal_status, plain_path.c_str(),
+                                                  sealed_path.c_str(), chunk_size,
+                                                  &sealed_bytes, &sealed_sum);
+        seal_cycles += CycleCounter::elapsed_since(begin);
+        if (ret != SGX_SUCCESS || seal_status != SEALED_STREAM_OK) {
+            std::cerr << "Stream seal failed (sgx " << ret << ", status " << seal_status << ")\n";
+            ok = false;
+            break;
+        }
+
+        cache.condition();
+        begin = CycleCounter::start();
+        ret = ecall_stream_unseal_file(global_eid, &unseal_status, sealed_path.c_str(),
+                                       &unsealed_bytes, &unsealed_sum);
+        unseal_cycles += CycleCounter::elapsed_since(begin);
+        if (ret != SGX_SUCCESS || unseal_status != SEALED_STREAM_OK) {
+            std::cerr << "Stream unseal failed (sgx " << ret << ", status " << unseal_status << ")\n";
+            ok = false;
+            break;
+        }
+
+        if (sealed_bytes != plain_size || unsealed_bytes != plain_size || sealed_sum != unsealed_sum) {
+            result.verified = false;
+        }
+    }
+
+    std::remove(plain_path.c_str());
+    std::remove(sealed_path.c_str());
+    if (!ok) return false;
+
+    double bytes = static_cast<double>(plain_size) * passes;
+    double seal_ns = CycleCounter::cycles_to_ns(static_cast<double>(seal_cycles));
+    double unseal_ns = CycleCounter::cycles_to_ns(static_cast<double>(unseal_cycles));
+    result.passes = passes;
+    result.seal_mb_per_s = seal_ns > 0.0 ? bytes / seal_ns * 1e3 : 0.0;
+    result.unseal_mb_per_s = unseal_ns > 0.0 ? bytes / unseal_ns * 1e3 : 0.0;
+    result.seal_cycles_per_byte = bytes > 0.0 ? static_cast<double>(seal_cycles) / bytes : 0.0;
+    result.unseal_cycles_per_byte = bytes > 0.0 ? static_cast<double>(unseal_cycles) / bytes : 0.0;
+    return true;
+}
+
+// Reads each payload size through both the marshalled [out] path and the
+// registered user_check ring. The I/O and checksum work are identical, so
+// the difference between the two is the cost of the bridge's copies.
+std::vector<PayloadPoint> BenchmarkRunner::benchmark_zero_copy(const std::string& filename,
+                                                               const std::vector<long long>& payloads,
+                                                               int iterations) {
+    std::vector<PayloadPoint> points;
+    long long max_payload = 0;
+    for (long long payload : payloads) {
+        if (payload < 1 || payload > FILE_RING_MAX_SLOT_SIZE) {
+            std::cerr << "Payload sizes must be between 1 and " << FILE_RING_MAX_SLOT_SIZE << " bytes\n";
+            return points;
+        }
+        if (payload > max_payload) max_payload = payload;
+    }
+    if (max_payload == 0) return points;
+
+    std::string path = filename + ".payload";
+    size_t slot_size = static_cast<size_t>(max_payload);
+    int status = -1;
+    if (!write_random_file(path, slot_size) ||
+        !g_file_ring.allocate(FILE_RING_DEFAULT_SLOTS, slot_size) ||
+        ecall_register_file_ring(global_eid, &status, g_file_ring.data(),
+                                 g_file_ring.slot_count(), slot_size) != SGX_SUCCESS ||
+        status != 0) {
+        std::cerr << "Failed to set up the file ring\n";
+        g_file_ring.release();
+        std::remove(path.c_str());
+        return points;
+    }
+
+    const char* name = path.c_str();
+    for (long long payload : payloads) {
+        size_t bytes = static_cast<size_t>(payload);
+        PayloadPoint point;
+        point.payload = bytes;
+
+        point.marshalled = time_loop(iterations, [name, bytes](int) {
+            int ret;
+            ecall_file_read_marshalled(global_eid, &ret, name, bytes);
+        });
+
+        point.ring = time_loop(iterations, [name, bytes](int) {
+            int ret;
+            ecall_file_read_ring(global_eid, &ret, name, bytes);
+        });
+        points.push_back(point);
+    }
+
+    ecall_register_file_ring(global_eid, &status, nullptr, 0, 0);
+    g_file_ring.release();
+    std::remove(path.c_str());
+    return points;
+}
+
+// Times one ecall_measure_marshal_ocall run of `iterations` OCALLs. As with
+// pure_ocall the single ECALL is amortised over the loop; per-op latency is
+// not available here.
+BenchmarkResult BenchmarkRunner::time_ocall_loop(int direction, uint8_t* buffer, size_t len,
+                                                 int iterations) {
+    cache.condition();
+    if (collect_perf) perf_counters.enable();
+    auto start_time = std::chrono::high_resolution_clock::now();
+    uint64_t start_cycles = CycleCounter::start();
+
+    int status = -1;
+    sgx_status_t ret = ecall_measure_marshal_ocall(global_eid, &status, direction, buffer, len,
+                                                   iterations);
+
+    uint64_t total_cycles = CycleCounter::elapsed_since(start_cycles);
     auto end_time = std::chrono::high_resolution_clock::now();
-    uint64_t end_cycles = CycleCounter::get_cycles();
+    if (collect_perf) perf_counters.disable();
 
-    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time);
-    uint64_t total_cycles = end_cycles - start_cycles;
+    if (ret != SGX_SUCCESS || status != 0) {
+        std::cerr << "Marshalling OCALL benchmark failed" << std::endl;
+        return {0.0, 0, 0.0, LatencyStats()};
+    }
 
-    return {
+    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time);
+    BenchmarkResult result = {
         static_cast<double>(duration.count()) / 1000.0,
         total_cycles,
-        static_cast<double>(total_cycles) / iterations
+        static_cast<double>(total_cycles) / iterations,
+        LatencyStats()
     };
+    if (collect_perf) {
+        result.perf = perf_counters.read(static_cast<uint64_t>(iterations));
+    }
+    return result;
 }
 
-BenchmarkResult BenchmarkRunner::benchmark_crypto_workload(int iterations) {
-    flush_caches();
+// Sweeps every buffer direction of ECALLs and OCALLs over the payload
+// sizes. Large payloads run fewer calls: at most `iterations`, but only as
+// many as keep each cell near 256 MB of payload (at least 10 calls).
+// OCALL payloads above MARSHAL_MAX_OCALL_SIZE are skipped.
+std::vector<MarshalPoint> BenchmarkRunner::benchmark_marshalling(const std::vector<long long>& payloads,
+                                                                 int iterations) {
+    static const char* const ecall_names[MARSHAL_DIRECTION_COUNT] = {
+        "ecall_in", "ecall_out", "ecall_inout", "ecall_user_check"
+    };
+    static const char* const ocall_names[MARSHAL_DIRECTION_COUNT] = {
+        "ocall_in", "ocall_out", "ocall_inout", "ocall_user_check"
+    };
 
-    uint64_t start_cycles = CycleCounter::get_cycles();
-    auto start_time = std::chrono::high_resolution_clock::now();
+    std::vector<MarshalPoint> points;
+    for (long long payload : payloads) {
+        if (payload < 0) continue;
+        size_t len = static_cast<size_t>(payload);
+        const int calls = static_cast<int>(ops_within_budget(payload, iterations > 0 ? iterations : 1));
 
-    for (int i = 0; i < iterations; i++) {
-        ecall_crypto_workload(global_eid);
+        std::vector<uint8_t> buffer(len > 0 ? len : 1);
+        uint8_t* data = buffer.data();
+
+        for (int direction = 0; direction < MARSHAL_DIRECTION_COUNT; direction++) {
+            MarshalPoint point = {ecall_names[direction], len, calls, BenchmarkResult()};
+            switch (direction) {
+                case MARSHAL_IN:
+                    point.result = time_loop(calls, [data, len](int) {
+                        ecall_marshal_in(global_eid, data, len);
+                    });
+                    break;
+                case MARSHAL_OUT:
+                    point.result = time_loop(calls, [data, len](int) {
+                        ecall_marshal_out(global_eid, data, len);
+                    });
+                    break;
+                case MARSHAL_INOUT:
+                    point.result = time_loop(calls, [data, len](int) {
+                        ecall_marshal_inout(global_eid, data, len);
+                    });
+                    break;
+                default:
+                    point.result = time_loop(calls, [data, len](int) {
+                        int ret;
+                        ecall_marshal_user_check(global_eid, &ret, data, len);
+                    });
+                    break;
+            }
+            points.push_back(point);
+        }
+
+        if (len > MARSHAL_MAX_OCALL_SIZE) continue;
+        for (int direction = 0; direction < MARSHAL_DIRECTION_COUNT; direction++) {
+            MarshalPoint point = {ocall_names[direction], len, calls,
+                                  time_ocall_loop(direction, data, len, calls)};
+            points.push_back(point);
+        }
     }
+    return points;
+}
 
-    auto end_time = std::chrono::high_resolution_clock::now();
-    uint64_t end_cycles = CycleCounter::get_cycles();
+// For every working-set size, allocates the set inside the enclave
+// (untimed; this touches every page once) and times `accesses` accesses in
+// each pattern with a single ECALL, so the transition is amortised away.
+// Stops at the first size the enclave heap cannot hold.
+std::vector<WorkingSetPoint> BenchmarkRunner::benchmark_working_set(const std::vector<long long>& sizes,
+                                                                    uint64_t accesses) {
+    static const char* const pattern_names[WORKING_SET_PATTERN_COUNT] = {
+        "sequential", "random", "chase"
+    };
 
-    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time);
-    uint64_t total_cycles = end_cycles - start_cycles;
+    std::vector<WorkingSetPoint> points;
+    for (long long size : sizes) {
+        if (size < 2 * WORKING_SET_LINE_SIZE) continue;
 
-    return {
-        static_cast<double>(duration.count()) / 1000.0,
-        total_cycles,
-        static_cast<double>(total_cycles) / iterations
+        int status = -1;
+        sgx_status_t ret = ecall_working_set_prepare(global_eid, &status, static_cast<size_t>(size),
+                                                     static_cast<uint64_t>(size));
+        if (ret != SGX_SUCCESS || status != 0) {
+            std::cerr << "Working set of " << size << " bytes does not fit the enclave heap"
+                      << " (raise SGX_HEAP_MAX); stopping the sweep\n";
+            break;
+        }
+
+        for (int pattern = 0; pattern < WORKING_SET_PATTERN_COUNT; pattern++) {
+            uint64_t checksum = 0;
+            cache.condition();
+            if (collect_perf) perf_counters.enable();
+            uint64_t start_cycles = CycleCounter::start();
+            ret = ecall_working_set_touch(global_eid, &status, pattern, accesses, &checksum);
+            uint64_t total_cycles = CycleCounter::elapsed_since(start_cycles);
+            if (collect_perf) perf_counters.disable();
+
+            if (ret != SGX_SUCCESS || status != 0) {
+                std::cerr << "Working set access failed\n";
+                continue;
+            }
+            WorkingSetPoint point = {pattern_names[pattern], static_cast<uint64_t>(size), accesses,
+                                     static_cast<double>(total_cycles) / static_cast<double>(accesses)};
+            if (collect_perf) {
+                point.perf = perf_counters.read(accesses);
+            }
+            points.push_back(point);
+        }
+    }
+    ecall_working_set_release(global_eid);
+    return points;
+}
+
+// Every sgx_tcrypto operation at every message size. Each cell is one
+// ECALL running the operation back to back, after an untimed single-op
+// call; large messages get fewer operations to bound the bytes processed.
+std::vector<CryptoPoint> BenchmarkRunner::benchmark_crypto_suite(const std::vector<long long>& sizes,
+                                                                 int iterations) {
+    static const char* const op_names[CRYPTO_OP_COUNT] = {
+        "sha256", "aes_gcm_encrypt", "aes_gcm_decrypt", "hmac_sha256", "ecdsa_sign"
+    };
+
+    std::vector<CryptoPoint> points;
+    long long max_bytes = 0;
+    for (long long size : sizes) {
+        if (size > max_bytes) max_bytes = size;
+    }
+    if (max_bytes > CRYPTO_SUITE_MAX_MESSAGE) {
+        std::cerr << "Crypto suite messages are limited to " << CRYPTO_SUITE_MAX_MESSAGE << " bytes\n";
+        return points;
+    }
+
+    int status = -1;
+    sgx_status_t ret = ecall_crypto_suite_prepare(global_eid, &status, static_cast<size_t>(max_bytes));
+    if (ret != SGX_SUCCESS || status != 0) {
+        std::cerr << "Failed to prepare the crypto suite\n";
+        return points;
+    }
+
+    for (long long size : sizes) {
+        if (size <= 0) continue;
+        size_t bytes = static_cast<size_t>(size);
+        const uint64_t ops = ops_within_budget(size, iterations > 0 ? iterations : 1);
+
+        for (int op = 0; op < CRYPTO_OP_COUNT; op++) {
+            ret = ecall_crypto_suite_run(global_eid, &status, op, bytes, 1);
+            if (ret != SGX_SUCCESS || status != 0) {
+                std::cerr << op_names[op] << " failed on " << bytes << " bytes\n";
+                continue;
+            }
+
+            cache.condition();
+            uint64_t start_cycles = CycleCounter::start();
+            ret = ecall_crypto_suite_run(global_eid, &status, op, bytes, ops);
+            uint64_t total_cycles = CycleCounter::elapsed_since(start_cycles);
+            if (ret != SGX_SUCCESS || status != 0) {
+                std::cerr << op_names[op] << " failed on " << bytes << " bytes\n";
+                continue;
+            }
+
+            CryptoPoint point;
+            point.op = op_names[op];
+            point.bytes = bytes;
+            point.ops = ops;
+            point.cycles_per_op = static_cast<double>(total_cycles) / static_cast<double>(ops);
+            point.cycles_per_byte = point.cycles_per_op / static_cast<double>(bytes);
+            double ns = CycleCounter::cycles_to_ns(point.cycles_per_op);
+            point.mb_per_s = ns > 0.0 ? static_cast<double>(bytes) / ns * 1e3 : 0.0;
+            points.push_back(point);
+        }
+    }
+    ecall_crypto_suite_release(global_eid);
+    return points;
+}
+
+// Flush strategies across region sizes: the original clflush + mfence per
+// request, clflushopt fenced per request, and the queued engine with
+// clflushopt or clwb. Strategies the CPU lacks are skipped.
+std::vector<FlushPoint> BenchmarkRunner::benchmark_flush(const std::vector<long long>& sizes,
+                                                         int iterations) {
+    struct Variant {
+        const char* name;
+        int strategy;
+        int batched;
     };
+    static const Variant variants[] = {
+        {"clflush", FLUSH_CLFLUSH, 0},
+        {"clflushopt_unbatched", FLUSH_CLFLUSHOPT, 0},
+        {"clflushopt", FLUSH_CLFLUSHOPT, 1},
+        {"clwb", FLUSH_CLWB, 1},
+    };
+
+    std::vector<FlushPoint> points;
+    for (long long size : sizes) {
+        if (size <= 0 || size > FLUSH_BENCH_MAX_BYTES) continue;
+        size_t bytes = static_cast<size_t>(size);
+        const uint64_t ops = ops_within_budget(size, iterations > 0 ? iterations : 1);
+
+        for (const Variant& variant : variants) {
+            int status = -1;
+            if (ecall_flush_benchmark(global_eid, &status, variant.strategy, variant.batched, bytes, 1)
+                    != SGX_SUCCESS || status != 0) {
+                continue;   // not supported here
+            }
+            cache.condition();
+            uint64_t start_cycles = CycleCounter::start();
+            ecall_flush_benchmark(global_eid, &status, variant.strategy, variant.batched, bytes, ops);
+            uint64_t total_cycles = CycleCounter::elapsed_since(start_cycles);
+
+            FlushPoint point;
+            point.strategy = variant.name;
+            point.bytes = bytes;
+            point.ops = ops;
+            point.cycles_per_op = static_cast<double>(total_cycles) / static_cast<double>(ops);
+            point.cycles_per_line = point.cycles_per_op / static_cast<double>((bytes + 63) / 64);
+            points.push_back(point);
+        }
+    }
+    ecall_flush_bench_release(global_eid);
+    return points;
 }
 
-void BenchmarkRunner::create_sealed_test_file(const std::string& filename) {
-    std::string test_data = "This is test data for SGX sealing benchmark. ";
-    for (int i = 0; i < 50; i++) {
-        test_data += "More test data " + std::to_string(i) + ". ";
+// Constant-time copy and zero at every size with each implementation the
+// enclave supports. `selected` receives the one picked automatically,
+// which is restored afterwards.
+std::vector<MemopsPoint> BenchmarkRunner::benchmark_memops(const std::vector<long long>& sizes,
+                                                           int iterations, std::string& selected) {
+    static const char* const level_names[MEMOPS_LEVEL_COUNT] = { "byte", "sse2", "avx2" };
+    static const char* const op_names[] = { "copy", "zero" };
+
+    std::vector<MemopsPoint> points;
+    int automatic = MEMOPS_BYTE;
+    if (ecall_memops_select(global_eid, &automatic, MEMOPS_AUTO) != SGX_SUCCESS) {
+        std::cerr << "Failed to query memops implementations\n";
+        return points;
+    }
+    selected = level_names[automatic];
+
+    for (int level = 0; level < MEMOPS_LEVEL_COUNT; level++) {
+        int in_use = -1;
+        if (ecall_memops_select(global_eid, &in_use, level) != SGX_SUCCESS || in_use != level) {
+            continue;   // not supported here
+        }
+        for (long long size : sizes) {
+            if (size <= 0 || size > MEMOPS_MAX_BYTES) continue;
+            size_t bytes = static_cast<size_t>(size);
+            const uint64_t ops = ops_within_budget(size, iterations > 0 ? iterations : 1);
+
+            for (int op = MEMOPS_OP_COPY; op <= MEMOPS_OP_ZERO; op++) {
+                int status = -1;
+                if (ecall_memops_run(global_eid, &status, op, bytes, 1) != SGX_SUCCESS || status != 0) {
+                    std::cerr << "memops " << op_names[op] << " failed on " << bytes << " bytes\n";
+                    continue;
+                }
+                cache.condition();
+                uint64_t start_cycles = CycleCounter::start();
+                ecall_memops_run(global_eid, &status, op, bytes, ops);
+                uint64_t total_cycles = CycleCounter::elapsed_since(start_cycles);
+
+                MemopsPoint point;
+                point.implementation = level_names[level];
+                point.op = op_names[op];
+                point.bytes = bytes;
+                point.ops = ops;
+                double cycles_per_op = static_cast<double>(total_cycles) / static_cast<double>(ops);
+                point.cycles_per_byte = cycles_per_op / static_cast<double>(bytes);
+                double ns = CycleCounter::cycles_to_ns(cycles_per_op);
+                point.mb_per_s = ns > 0.0 ? static_cast<double>(bytes) / ns * 1e3 : 0.0;
+                points.push_back(point);
+            }
+        }
     }
 
+    int restored = 0;
+    ecall_memops_select(global_eid, &restored, MEMOPS_AUTO);
+    ecall_memops_release(global_eid);
+    return points;
+}
+
+void BenchmarkRunner::create_sealed_test_file(const std::string& filename) {
+    std::string test_data = sealed_test_data();
+
     std::string sealed_filename = filename + ".sealed";
     ecall_create_sealed_file(global_eid, sealed_filename.c_str(),
                             test_data.c_str(), test_data.length());
@@ -5,25 +5,203 @@
 #include <string>
 #include <vector>
 #include <cstdint>
+#include <functional>
+#include "cache_conditioner.h"
+#include "latency_histogram.h"
+#include "perf_counters.h"
+#include "sgx_error.h"
+#include "sgx_uswitchless.h"
 
 struct BenchmarkResult {
     double time_ms;
     uint64_t cycles;
     double cycles_per_op;
+    // Only populated when per-operation timing is enabled
+    LatencyStats latency;
+    // Only valid when perf counters are enabled and available
+    PerfCounts perf = PerfCounts();
 };
 
+enum class TransitionMode {
+    Classic,
+    Switchless
+};
+
+struct SwitchlessOptions {
+    uint32_t untrusted_workers;
+    uint32_t trusted_workers;
+    uint32_t retries_before_fallback;
+    uint32_t retries_before_sleep;
+};
+
+struct ThreadResult {
+    int thread_id;
+    int cpu;
+    uint64_t cycles;
+    double cycles_per_op;
+    int failed_calls;
+    LatencyStats latency;
+};
+
+struct ScalingPoint {
+    int threads;
+    double wall_ms;
+    double ops_per_sec;
+    std::vector<ThreadResult> per_thread;
+};
+
+struct StreamResult {
+    uint64_t plain_bytes;
+    uint32_t chunk_size;
+    int passes;
+    double seal_mb_per_s;
+    double unseal_mb_per_s;
+    double seal_cycles_per_byte;
+    double unseal_cycles_per_byte;
+    // Unsealed checksum matched the sealed one on every pass
+    bool verified;
+};
+
+struct PayloadPoint {
+    size_t payload;
+    BenchmarkResult marshalled;
+    BenchmarkResult ring;
+};
+
+struct MarshalPoint {
+    std::string direction;      // ecall_in, ecall_out, ..., ocall_user_check
+    size_t payload;
+    int iterations;
+    BenchmarkResult result;
+};
+
+struct WorkingSetPoint {
+    std::string pattern;        // sequential, random or chase
+    uint64_t bytes;
+    uint64_t accesses;
+    double cycles_per_access;
+    // Per access; only valid when perf counters are enabled and available
+    PerfCounts perf = PerfCounts();
+};
+
+struct CryptoPoint {
+    std::string op;             // sha256, aes_gcm_encrypt, ..., ecdsa_sign
+    size_t bytes;
+    uint64_t ops;
+    double cycles_per_op;
+    double cycles_per_byte;
+    double mb_per_s;
+};
+
+struct MemopsPoint {
+    std::string implementation; // byte, sse2 or avx2
+    std::string op;             // copy or zero
+    size_t bytes;
+    uint64_t ops;
+    double cycles_per_byte;
+    double mb_per_s;
+};
+
+struct FlushPoint {
+    std::string strategy;       // clflush, clflushopt_unbatched, clflushopt or clwb
+    size_t bytes;
+    uint64_t ops;
+    double cycles_per_op;
+    double cycles_per_line;
+};
+
+struct StartupPoint {
+    std::string image;
+    long long heap_bytes;       // from the image name; 0 when not encoded
+    long long stack_bytes;
+    int tcs;
+    int runs;
+    LatencyStats create;        // sgx_create_enclave (EADD/EEXTEND/EINIT)
+    LatencyStats first_ecall;   // first ECALL into the new enclave
+    LatencyStats destroy;       // sgx_destroy_enclave
+    double pooled_cycles;       // borrow from a warm EnclavePool, one ECALL, return
+};
+
+struct HardeningPoint {
+    std::string test;           // untrusted_file, sealed_file or crypto
+    std::string placement;      // lfence<stride>, entry or mask
+    BenchmarkResult result;
+};
+
+struct SealKeyPoint {
+    std::string path;           // unseal_data, derive, cached or rotate
+    BenchmarkResult result;
+};
+
+// Which build of the workload code the ecall_* functions reach: "native"
+// (linked in as host code, no enclave transitions), "sgx-sim" or "sgx-hw".
+// Set by the Makefile target that built the binary.
+#ifndef BENCHMARK_BACKEND
+#define BENCHMARK_BACKEND "sgx-hw"
+#endif
+
 class BenchmarkRunner {
 private:
-    void flush_caches();
+    bool per_op_timing = false;
+    TransitionMode transition = TransitionMode::Classic;
+    bool collect_perf = false;
+    LatencyHistogram histogram;
+    PerfCounterGroup perf_counters;
+    CacheConditioner cache;
+
+    template <typename Operation>
+    BenchmarkResult time_loop(int iterations, Operation op);
+
+    std::function<sgx_status_t(int)> make_operation(const std::string& test_type,
+                                                    const std::string& filename);
+    BenchmarkResult time_ocall_loop(int direction, uint8_t* buffer, size_t len, int iterations);
+    ScalingPoint run_threads(const std::function<sgx_status_t(int)>& op,
+                             int iterations, int threads);
 
 public:
+    static const char* backend() { return BENCHMARK_BACKEND; }
     void setup_environment();
+    void set_per_op_timing(bool enabled) { per_op_timing = enabled; }
+    void set_transition_mode(TransitionMode mode) { transition = mode; }
+    bool enable_perf_counters();
+    // Cache state every timed operation starts from (see cache_conditioner.h).
+    // Loops of ECALLs condition before each call; benchmarks that loop
+    // inside one ECALL, and threaded runs, condition once before it.
+    bool set_cache_state(const std::string& name) { return cache.select(name); }
+    const CacheConditioner& cache_conditioner() const { return cache; }
+    static sgx_uswitchless_config_t make_switchless_config(const SwitchlessOptions& options);
+    bool run_test(const std::string& test_type, const std::string& filename,
+                  int iterations, BenchmarkResult& result);
     BenchmarkResult benchmark_empty_ecall(int iterations);
     BenchmarkResult benchmark_pure_ocall(int iterations);
     BenchmarkResult benchmark_ping_pong(int iterations);
     BenchmarkResult benchmark_file_read(const std::string& filename, int iterations);
     BenchmarkResult benchmark_sgx_file_read(const std::string& filename, int iterations);
     BenchmarkResult benchmark_crypto_workload(int iterations);
+    BenchmarkResult benchmark_alloc(int iterations);
+    bool prepare_session_file(const std::string& filename);
+    BenchmarkResult benchmark_session_file_read(const std::string& filename, int iterations, int mode);
+    std::vector<SealKeyPoint> benchmark_seal_key(const std::string& filename, int iterations);
+    std::vector<StartupPoint> benchmark_startup(const std::vector<std::string>& images, int iterations);
+    std::vector<HardeningPoint> benchmark_hardening(const std::string& filename, int iterations);
+    std::vector<CryptoPoint> benchmark_crypto_suite(const std::vector<long long>& sizes, int iterations);
+    std::vector<FlushPoint> benchmark_flush(const std::vector<long long>& sizes, int iterations);
+    std::vector<MemopsPoint> benchmark_memops(const std::vector<long long>& sizes, int iterations,
+                                              std::string& selected);
+    BenchmarkResult benchmark_batch(const std::string& test_type, const std::string& filename,
+                                    int iterations, int batch_size);
+    std::vector<ScalingPoint> benchmark_thread_scaling(const std::string& test_type,
+                                                       const std::string& filename,
+                                                       int iterations, int max_threads);
+    bool benchmark_sealed_stream(const std::string& filename, uint64_t plain_size,
+                                 uint32_t chunk_size, int max_passes, StreamResult& result);
+    std::vector<PayloadPoint> benchmark_zero_copy(const std::string& filename,
+                                                  const std::vector<long long>& payloads,
+                                                  int iterations);
+    std::vector<MarshalPoint> benchmark_marshalling(const std::vector<long long>& payloads,
+                                                    int iterations);
+    std::vector<WorkingSetPoint> benchmark_working_set(const std::vector<long long>& sizes,
+                                                       uint64_t accesses);
     void create_sealed_test_file(const std::string& filename);
 };
 
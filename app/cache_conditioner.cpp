@@ -0,0 +1,156 @@
+// app/cache_conditioner.cpp
+#include "cache_conditioner.h"
+#include <cerrno>
+#include <cpuid.h>
+#include <cstring>
+#include <iostream>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace {
+
+const size_t PAGE_BYTES = 4096;
+
+// One subleaf of CPUID.(EAX=4) per cache, until a null type. Leaves
+// fields at 0 for levels it does not see (and on CPUs without the leaf).
+void cpuid_caches(CacheTopology& caches) {
+    unsigned int eax, ebx, ecx, edx;
+    if (__get_cpuid_max(0, nullptr) < 4) return;
+
+    unsigned int llc_level = 0;
+    for (unsigned int subleaf = 0; subleaf < 16; subleaf++) {
+        __cpuid_count(4, subleaf, eax, ebx, ecx, edx);
+        unsigned int type = eax & 0x1F;
+        if (type == 0) break;
+        if (type == 2) continue;        // instruction cache
+
+        unsigned int level = (eax >> 5) & 0x7;
+        size_t line = (ebx & 0xFFF) + 1;
+        size_t partitions = ((ebx >> 12) & 0x3FF) + 1;
+        size_t ways = ((ebx >> 22) & 0x3FF) + 1;
+        size_t bytes = ways * partitions * line * (static_cast<size_t>(ecx) + 1);
+        if (level == 1) {
+            caches.l1d_bytes = bytes;
+            caches.line_bytes = line;
+        } else if (level == 2) {
+            caches.l2_bytes = bytes;
+        }
+        if (level > llc_level) {
+            llc_level = level;
+            caches.llc_bytes = bytes;
+        }
+    }
+}
+
+size_t sysconf_bytes(int name) {
+    long value = sysconf(name);
+    return value > 0 ? static_cast<size_t>(value) : 0;
+}
+
+} // namespace
+
+CacheTopology detect_cache_topology() {
+    CacheTopology caches = {0, 0, 0, 0};
+    cpuid_caches(caches);
+
+    if (caches.line_bytes == 0) caches.line_bytes = sysconf_bytes(_SC_LEVEL1_DCACHE_LINESIZE);
+    if (caches.l1d_bytes == 0) caches.l1d_bytes = sysconf_bytes(_SC_LEVEL1_DCACHE_SIZE);
+    if (caches.l2_bytes == 0) caches.l2_bytes = sysconf_bytes(_SC_LEVEL2_CACHE_SIZE);
+    if (caches.llc_bytes == 0) caches.llc_bytes = sysconf_bytes(_SC_LEVEL3_CACHE_SIZE);
+    if (caches.llc_bytes == 0) caches.llc_bytes = caches.l2_bytes;
+
+    // Sizes at least as large as any current x86 part, so eviction still works
+    if (caches.line_bytes == 0 || caches.line_bytes > PAGE_BYTES) caches.line_bytes = 64;
+    if (caches.l1d_bytes == 0) caches.l1d_bytes = 64 * 1024;
+    if (caches.l2_bytes == 0) caches.l2_bytes = 2 * 1024 * 1024;
+    if (caches.llc_bytes == 0) caches.llc_bytes = 32 * 1024 * 1024;
+    return caches;
+}
+
+CacheConditioner::CacheConditioner()
+    : mode(CacheState::Warm), caches(detect_cache_topology()), buffer(nullptr),
+      buffer_bytes(0), mapped_bytes(0), sink(0) {}
+
+CacheConditioner::~CacheConditioner() {
+    release();
+}
+
+void CacheConditioner::release() {
+    if (buffer) munmap(buffer, mapped_bytes);
+    buffer = nullptr;
+    buffer_bytes = 0;
+    mapped_bytes = 0;
+}
+
+bool CacheConditioner::select(const std::string& state_name) {
+    CacheState next;
+    size_t bytes;
+    if (state_name == "warm") {
+        next = CacheState::Warm;
+        bytes = 0;
+    } else if (state_name == "cold_llc") {
+        // Twice L2 + LLC also clears non-inclusive LLCs, whose lines may
+        // live only in L2
+        next = CacheState::ColdLlc;
+        bytes = 2 * (caches.l2_bytes + caches.llc_bytes);
+    } else if (state_name == "cold_l1d") {
+        next = CacheState::ColdL1d;
+        bytes = 2 * caches.l1d_bytes;
+    } else if (state_name == "tlb") {
+        next = CacheState::Tlb;
+        bytes = TLB_EVICT_PAGES * PAGE_BYTES;
+    } else {
+        return false;
+    }
+
+    release();
+    mode = CacheState::Warm;
+    if (bytes > 0) {
+        bytes = (bytes + PAGE_BYTES - 1) & ~(PAGE_BYTES - 1);
+        void* map = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (map == MAP_FAILED) {
+            std::cerr << "cache conditioner: cannot map " << bytes << " bytes: " << strerror(errno) << "\n";
+            return false;
+        }
+        // Huge pages would cover the TLB buffer with a handful of entries
+        if (next == CacheState::Tlb) madvise(map, bytes, MADV_NOHUGEPAGE);
+
+        buffer = static_cast<uint8_t*>(map);
+        mapped_bytes = bytes;
+        // Fault every page in now rather than during the first measurement
+        memset(buffer, 0x5A, bytes);
+        buffer_bytes = next == CacheState::Tlb ? TLB_EVICT_PAGES * caches.line_bytes : bytes;
+    }
+    mode = next;
+    return true;
+}
+
+const char* CacheConditioner::name() const {
+    switch (mode) {
+        case CacheState::ColdLlc: return "cold_llc";
+        case CacheState::ColdL1d: return "cold_l1d";
+        case CacheState::Tlb: return "tlb";
+        default: return "warm";
+    }
+}
+
+void CacheConditioner::condition() {
+    if (mode == CacheState::Warm) return;
+
+    uint64_t sum = 0;
+    const size_t line = caches.line_bytes;
+    if (mode == CacheState::Tlb) {
+        // A different line in each page spreads the touches over the cache
+        // sets instead of piling them into one
+        const size_t lines_per_page = PAGE_BYTES / line;
+        for (size_t page = 0; page < TLB_EVICT_PAGES; page++) {
+            sum += buffer[page * PAGE_BYTES + (page % lines_per_page) * line];
+        }
+    } else {
+        for (size_t i = 0; i < mapped_bytes; i += line) {
+            sum += buffer[i];
+        }
+    }
+    sink = sum;
+    __asm__ volatile ("mfence" ::: "memory");
+}
@@ -0,0 +1,75 @@
+// app/cache_conditioner.h - Cache and TLB state before measured operations
+#ifndef CACHE_CONDITIONER_H
+#define CACHE_CONDITIONER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Data cache sizes of the CPU the app runs on, from CPUID leaf 4, then
+// sysconf, then conservative defaults for anything neither reports
+struct CacheTopology {
+    size_t line_bytes;
+    size_t l1d_bytes;
+    size_t l2_bytes;
+    size_t llc_bytes;
+};
+
+CacheTopology detect_cache_topology();
+
+// Cache state each measured operation starts from:
+//  - warm:     nothing is done; every operation runs on what the previous
+//              one left behind (the default)
+//  - cold_llc: reads an eviction buffer of twice L2 + LLC, so the
+//              operation's code and data come from DRAM (through the MEE
+//              for EPC pages)
+//  - cold_l1d: reads a buffer of twice the L1D; L2 and LLC stay warm
+//  - tlb:      touches one line on each of TLB_EVICT_PAGES pages, which
+//              evicts the dTLB and STLB entries with a cache footprint of
+//              only TLB_EVICT_PAGES lines. Enclave entry and exit flush the
+//              enclave's own TLB entries already, so this mostly affects
+//              untrusted pages (OCALL buffers, the untrusted runtime).
+enum class CacheState {
+    Warm,
+    ColdLlc,
+    ColdL1d,
+    Tlb
+};
+
+// Puts the caches into the selected state. The buffers are allocated and
+// faulted in when the state is selected, so condition() allocates nothing
+// and costs the same every time; callers keep it out of timed intervals.
+class CacheConditioner {
+public:
+    static const size_t TLB_EVICT_PAGES = 4096;
+
+    CacheConditioner();
+    ~CacheConditioner();
+    CacheConditioner(const CacheConditioner&) = delete;
+    CacheConditioner& operator=(const CacheConditioner&) = delete;
+
+    // Accepts warm, cold_llc, cold_l1d or tlb; false for anything else or
+    // when the buffer cannot be allocated
+    bool select(const std::string& state_name);
+    CacheState state() const { return mode; }
+    const char* name() const;
+    // True when operations must be conditioned (and timed) one by one
+    bool per_operation() const { return mode != CacheState::Warm; }
+    const CacheTopology& topology() const { return caches; }
+    // Bytes of buffer the selected state reads on every condition()
+    size_t footprint() const { return buffer_bytes; }
+
+    void condition();
+
+private:
+    CacheState mode;
+    CacheTopology caches;
+    uint8_t* buffer;
+    size_t buffer_bytes;
+    size_t mapped_bytes;
+    volatile uint64_t sink;
+
+    void release();
+};
+
+#endif // CACHE_CONDITIONER_H
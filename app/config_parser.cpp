@@ -5,6 +5,60 @@
 
 extern MitigationConfig g_app_config;
 
+// Dispatch mode, flush strategy and barrier placement survive parse_mitigations() so sweeps
+// and repetitions that re-parse the mitigation list keep the modes chosen
+// on the command line.
+static bool g_static_dispatch = false;
+static int g_flush_strategy = FLUSH_CLFLUSH;
+static int g_hardening = HARDENING_LFENCE;
+static uint32_t g_barrier_stride = HARDENING_DEFAULT_STRIDE;
+
+void set_static_dispatch(bool enabled) {
+    g_static_dispatch = enabled;
+    g_app_config.static_dispatch = enabled;
+}
+
+bool set_flush_strategy(const std::string& name) {
+    int strategy;
+    if (name == "auto") strategy = FLUSH_AUTO;
+    else if (name == "clflush") strategy = FLUSH_CLFLUSH;
+    else if (name == "clflushopt") strategy = FLUSH_CLFLUSHOPT;
+    else if (name == "clwb") strategy = FLUSH_CLWB;
+    else return false;
+
+    g_flush_strategy = strategy;
+    g_app_config.flush_strategy = strategy;
+    return true;
+}
+
+const char* flush_strategy_name(int strategy) {
+    switch (strategy) {
+        case FLUSH_CLFLUSH: return "clflush";
+        case FLUSH_CLFLUSHOPT: return "clflushopt";
+        case FLUSH_CLWB: return "clwb";
+        default: return "auto";
+    }
+}
+
+bool set_hardening(const std::string& name) {
+    int hardening;
+    if (name == "lfence") hardening = HARDENING_LFENCE;
+    else if (name == "mask") hardening = HARDENING_MASK;
+    else return false;
+
+    g_hardening = hardening;
+    g_app_config.hardening = hardening;
+    return true;
+}
+
+bool set_barrier_stride(long long stride) {
+    if (stride < 0 || stride > (1LL << 20) || (stride & (stride - 1)) != 0) return false;
+
+    g_barrier_stride = static_cast<uint32_t>(stride);
+    g_app_config.barrier_stride = g_barrier_stride;
+    return true;
+}
+
 static void set_mitigation_flag(const std::string& flag) {
     if (flag == "lfence") g_app_config.lfence_barrier = true;
     else if (flag == "mfence") g_app_config.mfence_barrier = true;
@@ -15,6 +69,10 @@ static void set_mitigation_flag(const std::string& flag) {
 
 void parse_mitigations(const std::string& mitigation_str) {
     init_mitigation_config(&g_app_config);
+    g_app_config.static_dispatch = g_static_dispatch;
+    g_app_config.flush_strategy = g_flush_strategy;
+    g_app_config.hardening = g_hardening;
+    g_app_config.barrier_stride = g_barrier_stride;
 
     if (mitigation_str.empty() || mitigation_str == "none") return;
     if (mitigation_str == "all") {
@@ -45,4 +103,41 @@ void print_config() {
     std::cout << "  Cache flushing:       " << (g_app_config.cache_flushing ? "ON" : "OFF") << "\n";
     std::cout << "  Constant time ops:    " << (g_app_config.constant_time_ops ? "ON" : "OFF") << "\n";
     std::cout << "  Memory barriers:      " << (g_app_config.memory_barriers ? "ON" : "OFF") << "\n";
+    std::cout << "  Dispatch:             " << (g_app_config.static_dispatch ? "static" : "runtime") << "\n";
+    std::cout << "  Flush strategy:       " << flush_strategy_name(g_app_config.flush_strategy) << "\n";
+    if (g_app_config.hardening == HARDENING_MASK) {
+        std::cout << "  Hardening:            index masking\n";
+    } else if (g_app_config.barrier_stride == 0) {
+        std::cout << "  Hardening:            entry barriers only\n";
+    } else {
+        std::cout << "  Hardening:            barrier every " << g_app_config.barrier_stride
+                  << " iterations\n";
+    }
+}
+
+// Parses a comma-separated list of sizes; each entry may carry a K, M or G
+// suffix (powers of 1024). Malformed entries are reported and skipped.
+std::vector<long long> parse_size_list(const std::string& list_str) {
+    std::vector<long long> sizes;
+    std::string remaining = list_str + ",";
+    size_t pos = 0;
+    while ((pos = remaining.find(',')) != std::string::npos) {
+        std::string token = remaining.substr(0, pos);
+        remaining.erase(0, pos + 1);
+        if (token.empty()) continue;
+
+        long long multiplier = 1;
+        char suffix = token.back();
+        if (suffix == 'K' || suffix == 'k') multiplier = 1LL << 10;
+        else if (suffix == 'M' || suffix == 'm') multiplier = 1LL << 20;
+        else if (suffix == 'G' || suffix == 'g') multiplier = 1LL << 30;
+        if (multiplier != 1) token.pop_back();
+
+        try {
+            sizes.push_back(std::stoll(token) * multiplier);
+        } catch (const std::exception&) {
+            std::cerr << "Ignoring invalid size: " << token << "\n";
+        }
+    }
+    return sizes;
 }
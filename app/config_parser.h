@@ -3,8 +3,18 @@
 #define CONFIG_PARSER_H
 
 #include <string>
+#include <vector>
 
 void parse_mitigations(const std::string& mitigation_str);
 void print_config();
+void set_static_dispatch(bool enabled);
+// Accepts auto, clflush, clflushopt or clwb; false for anything else
+bool set_flush_strategy(const std::string& name);
+const char* flush_strategy_name(int strategy);
+// Accepts lfence or mask; false for anything else
+bool set_hardening(const std::string& name);
+// Accepts 0 or a power of two up to 1M; false for anything else
+bool set_barrier_stride(long long stride);
+std::vector<long long> parse_size_list(const std::string& list_str);
 
 #endif // CONFIG_PARSER_H
@@ -0,0 +1,15 @@
+// app/crypto_suite_types.h - Operations of the sgx_tcrypto benchmark suite
+#ifndef CRYPTO_SUITE_TYPES_H
+#define CRYPTO_SUITE_TYPES_H
+
+#define CRYPTO_OP_SHA256 0
+#define CRYPTO_OP_AES_GCM_ENCRYPT 1
+#define CRYPTO_OP_AES_GCM_DECRYPT 2
+#define CRYPTO_OP_HMAC_SHA256 3
+#define CRYPTO_OP_ECDSA_SIGN 4
+#define CRYPTO_OP_COUNT 5
+
+// Largest message in the sweep; sgx_tcrypto takes 32-bit (HMAC: int) lengths
+#define CRYPTO_SUITE_MAX_MESSAGE (1024 * 1024)
+
+#endif // CRYPTO_SUITE_TYPES_H
@@ -0,0 +1,63 @@
+// app/cycle_counter.cpp
+#include "cycle_counter.h"
+#include <algorithm>
+#include <chrono>
+#include <cpuid.h>
+#include <thread>
+
+uint64_t CycleCounter::overhead_cycles = 0;
+double CycleCounter::tsc_hz = 0.0;
+bool CycleCounter::tsc_invariant = false;
+const char* CycleCounter::frequency_source = "none";
+
+// Prefers the architectural TSC/crystal ratio (CPUID 0x15), then the
+// processor base frequency (CPUID 0x16), and finally measures the TSC
+// against the steady clock.
+double CycleCounter::detect_tsc_hz() {
+    unsigned int eax, ebx, ecx, edx;
+    unsigned int max_leaf = __get_cpuid_max(0, nullptr);
+
+    if (max_leaf >= 0x15) {
+        __cpuid_count(0x15, 0, eax, ebx, ecx, edx);
+        if (eax != 0 && ebx != 0 && ecx != 0) {
+            frequency_source = "cpuid 0x15";
+            return static_cast<double>(ecx) * ebx / eax;
+        }
+    }
+    if (max_leaf >= 0x16) {
+        __cpuid_count(0x16, 0, eax, ebx, ecx, edx);
+        if ((eax & 0xFFFF) != 0) {
+            frequency_source = "cpuid 0x16";
+            return static_cast<double>(eax & 0xFFFF) * 1e6;
+        }
+    }
+
+    auto wall_start = std::chrono::steady_clock::now();
+    uint64_t tsc_start = start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    uint64_t tsc_end = stop();
+    auto wall_end = std::chrono::steady_clock::now();
+
+    double seconds = std::chrono::duration<double>(wall_end - wall_start).count();
+    frequency_source = "measured";
+    return static_cast<double>(tsc_end - tsc_start) / seconds;
+}
+
+void CycleCounter::calibrate() {
+    unsigned int eax, ebx, ecx, edx;
+    if (__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx)) {
+        tsc_invariant = (edx & (1u << 8)) != 0;
+    }
+
+    // The minimum of many empty start/stop pairs is the fixed cost that
+    // every measured interval carries.
+    uint64_t best = UINT64_MAX;
+    for (int i = 0; i < 10000; i++) {
+        uint64_t begin = start();
+        uint64_t end = stop();
+        best = std::min(best, end - begin);
+    }
+    overhead_cycles = best;
+
+    tsc_hz = detect_tsc_hz();
+}
@@ -4,6 +4,10 @@
 
 #include <cstdint>
 
+// TSC-based timer. start()/stop() follow the rdtsc/rdtscp + lfence pattern:
+// start() keeps earlier work out of the interval, stop() waits for the
+// measured code to retire and keeps later work out. calibrate() must run
+// once before overhead() or cycles_to_ns() are used.
 class CycleCounter {
 private:
     static inline uint64_t rdtsc() {
@@ -12,17 +16,51 @@ private:
         return ((uint64_t)hi << 32) | lo;
     }
 
-    static inline void cpuid() {
-        __asm__ volatile ("cpuid" : : "a"(0) : "ebx", "ecx", "edx");
+    static inline uint64_t rdtscp() {
+        uint32_t lo, hi, aux;
+        __asm__ volatile ("rdtscp" : "=a" (lo), "=d" (hi), "=c" (aux));
+        return ((uint64_t)hi << 32) | lo;
+    }
+
+    static inline void lfence() {
+        __asm__ volatile ("lfence" ::: "memory");
     }
 
+    static uint64_t overhead_cycles;
+    static double tsc_hz;
+    static bool tsc_invariant;
+    static const char* frequency_source;
+
+    static double detect_tsc_hz();
+
 public:
-    static inline uint64_t get_cycles() {
-        cpuid();
+    static inline uint64_t start() {
+        lfence();
         uint64_t cycles = rdtsc();
-        cpuid();
+        lfence();
+        return cycles;
+    }
+
+    static inline uint64_t stop() {
+        uint64_t cycles = rdtscp();
+        lfence();
         return cycles;
     }
+
+    // Elapsed cycles since `begin` with the timer's own cost removed
+    static inline uint64_t elapsed_since(uint64_t begin) {
+        uint64_t delta = stop() - begin;
+        return delta > overhead_cycles ? delta - overhead_cycles : 0;
+    }
+
+    static void calibrate();
+    static uint64_t overhead() { return overhead_cycles; }
+    static bool invariant() { return tsc_invariant; }
+    static double frequency_hz() { return tsc_hz; }
+    static const char* frequency_origin() { return frequency_source; }
+    static double cycles_to_ns(double cycles) {
+        return tsc_hz > 0.0 ? cycles * 1e9 / tsc_hz : 0.0;
+    }
 };
 
 #endif // CYCLE_COUNTER_H
@@ -0,0 +1,75 @@
+// app/enclave_pool.cpp
+#include "enclave_pool.h"
+
+sgx_status_t create_enclave(const std::string& image, const sgx_uswitchless_config_t* switchless,
+                            sgx_enclave_id_t* eid) {
+    if (switchless) {
+        const void* enclave_ex_p[32] = {0};
+        enclave_ex_p[SGX_CREATE_ENCLAVE_EX_SWITCHLESS_BIT_IDX] = switchless;
+        return sgx_create_enclave_ex(image.c_str(), SGX_DEBUG_FLAG, nullptr, nullptr, eid, nullptr,
+                                     SGX_CREATE_ENCLAVE_EX_SWITCHLESS, enclave_ex_p);
+    }
+    sgx_launch_token_t token = {0};
+    int updated = 0;
+    return sgx_create_enclave(image.c_str(), SGX_DEBUG_FLAG, &token, &updated, eid, nullptr);
+}
+
+EnclavePool::EnclavePool(const std::string& image, size_t capacity,
+                         const sgx_uswitchless_config_t* switchless)
+    : image_(image), capacity_(capacity), switchless_(switchless != nullptr),
+      switchless_config_(switchless ? *switchless : sgx_uswitchless_config_t()) {}
+
+EnclavePool::~EnclavePool() {
+    for (sgx_enclave_id_t eid : idle_) {
+        sgx_destroy_enclave(eid);
+    }
+}
+
+bool EnclavePool::prewarm(size_t count) {
+    if (count > capacity_) count = capacity_;
+    for (;;) {
+        {
+            std::lock_guard<std::mutex> guard(lock_);
+            if (idle_.size() >= count) return true;
+        }
+        // Created outside the lock: EINIT of a large enclave takes
+        // milliseconds and must not stall other borrowers
+        sgx_enclave_id_t eid = 0;
+        if (create_enclave(image_, switchless_ ? &switchless_config_ : nullptr, &eid) != SGX_SUCCESS) {
+            return false;
+        }
+        release(eid);
+    }
+}
+
+sgx_enclave_id_t EnclavePool::acquire() {
+    {
+        std::lock_guard<std::mutex> guard(lock_);
+        if (!idle_.empty()) {
+            sgx_enclave_id_t eid = idle_.back();
+            idle_.pop_back();
+            return eid;
+        }
+    }
+    sgx_enclave_id_t eid = 0;
+    if (create_enclave(image_, switchless_ ? &switchless_config_ : nullptr, &eid) != SGX_SUCCESS) {
+        return 0;
+    }
+    return eid;
+}
+
+void EnclavePool::release(sgx_enclave_id_t eid) {
+    {
+        std::lock_guard<std::mutex> guard(lock_);
+        if (idle_.size() < capacity_) {
+            idle_.push_back(eid);
+            return;
+        }
+    }
+    sgx_destroy_enclave(eid);
+}
+
+size_t EnclavePool::idle() const {
+    std::lock_guard<std::mutex> guard(lock_);
+    return idle_.size();
+}
@@ -0,0 +1,66 @@
+// app/enclave_pool.h - Reusable pool of initialized enclaves
+#ifndef ENCLAVE_POOL_H
+#define ENCLAVE_POOL_H
+
+#include "sgx_urts.h"
+#include "sgx_uswitchless.h"
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Creates an enclave from a signed image, switchless when a config is given
+sgx_status_t create_enclave(const std::string& image, const sgx_uswitchless_config_t* switchless,
+                            sgx_enclave_id_t* eid);
+
+// Keeps up to `capacity` initialized enclaves of one image so callers can
+// borrow one instead of paying EADD/EEXTEND/EINIT on every session.
+// acquire() hands out an idle enclave, or creates one when none is idle;
+// release() parks it again, or destroys it when the pool is full. Thread
+// safe. Enclave state set by ECALLs (mitigation config, allocator, session
+// keys) survives a release, so borrowers re-apply whatever they rely on.
+class EnclavePool {
+public:
+    EnclavePool(const std::string& image, size_t capacity,
+                const sgx_uswitchless_config_t* switchless = nullptr);
+    ~EnclavePool();
+
+    // Creates enclaves until `count` are idle (at most capacity); returns
+    // false if a creation fails
+    bool prewarm(size_t count);
+    // 0 when no enclave is idle and creating one fails
+    sgx_enclave_id_t acquire();
+    void release(sgx_enclave_id_t eid);
+    size_t idle() const;
+    const std::string& image() const { return image_; }
+
+    // Borrows an enclave for the lifetime of the lease
+    class Lease {
+    public:
+        explicit Lease(EnclavePool& pool) : pool_(pool), eid_(pool.acquire()) {}
+        ~Lease() {
+            if (eid_ != 0) pool_.release(eid_);
+        }
+        sgx_enclave_id_t eid() const { return eid_; }
+        explicit operator bool() const { return eid_ != 0; }
+
+    private:
+        Lease(const Lease&);
+        Lease& operator=(const Lease&);
+
+        EnclavePool& pool_;
+        sgx_enclave_id_t eid_;
+    };
+
+private:
+    EnclavePool(const EnclavePool&);
+    EnclavePool& operator=(const EnclavePool&);
+
+    const std::string image_;
+    const size_t capacity_;
+    const bool switchless_;
+    sgx_uswitchless_config_t switchless_config_;
+    mutable std::mutex lock_;
+    std::vector<sgx_enclave_id_t> idle_;
+};
+
+#endif // ENCLAVE_POOL_H
@@ -0,0 +1,42 @@
+// app/enclave_variants.cpp
+#include "enclave_variants.h"
+#include <algorithm>
+#include <glob.h>
+
+static const char VARIANT_PREFIX[] = "enclave_";
+static const char VARIANT_SUFFIX[] = ".signed.so";
+
+std::string enclave_variant_path(const std::string& name) {
+    if (name.empty() || name == "default") return "enclave.signed.so";
+    return VARIANT_PREFIX + name + VARIANT_SUFFIX;
+}
+
+static std::vector<std::string> glob_paths(const std::string& pattern) {
+    std::vector<std::string> paths;
+    glob_t matches;
+    if (glob(pattern.c_str(), 0, nullptr, &matches) != 0) return paths;
+    for (size_t i = 0; i < matches.gl_pathc; i++) {
+        paths.push_back(matches.gl_pathv[i]);
+    }
+    globfree(&matches);
+    return paths;
+}
+
+std::vector<std::string> list_enclave_variants() {
+    std::vector<std::string> variants;
+    const size_t prefix_len = sizeof(VARIANT_PREFIX) - 1;
+    const size_t suffix_len = sizeof(VARIANT_SUFFIX) - 1;
+    for (const std::string& path : glob_paths(std::string(VARIANT_PREFIX) + "*" + VARIANT_SUFFIX)) {
+        variants.push_back(path.substr(prefix_len, path.size() - prefix_len - suffix_len));
+    }
+
+    std::sort(variants.begin(), variants.end());
+    auto baseline = std::find(variants.begin(), variants.end(), ENCLAVE_BASELINE_VARIANT);
+    if (baseline != variants.end()) std::rotate(variants.begin(), baseline, baseline + 1);
+    return variants;
+}
+
+std::vector<std::string> list_startup_images() {
+    // glob() returns its matches sorted
+    return glob_paths(std::string("startup/*") + VARIANT_SUFFIX);
+}
@@ -0,0 +1,24 @@
+// app/enclave_variants.h - Signed enclave images built with different compiler hardening
+#ifndef ENCLAVE_VARIANTS_H
+#define ENCLAVE_VARIANTS_H
+
+#include <string>
+#include <vector>
+
+// Reference variant: the enclave built without compiler mitigations
+#define ENCLAVE_BASELINE_VARIANT "baseline"
+
+// Image for a variant built by 'make variants': enclave_<name>.signed.so,
+// or the default enclave.signed.so for an empty name or "default"
+std::string enclave_variant_path(const std::string& name);
+
+// Variants present in the working directory, baseline first and the rest
+// in name order. Empty when none have been built.
+std::vector<std::string> list_enclave_variants();
+
+// Images from 'make startup-enclaves', startup/h<heap>_s<stack>_t<tcs>.signed.so:
+// the default enclave signed under other heap, stack and TCS settings.
+// Paths in name order; empty when none have been built.
+std::vector<std::string> list_startup_images();
+
+#endif // ENCLAVE_VARIANTS_H
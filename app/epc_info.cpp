@@ -0,0 +1,20 @@
+// app/epc_info.cpp
+#include "epc_info.h"
+#include <cpuid.h>
+
+uint64_t detect_epc_bytes() {
+    unsigned int eax, ebx, ecx, edx;
+    if (__get_cpuid_max(0, nullptr) < 0x12) return 0;
+
+    __cpuid_count(0x7, 0, eax, ebx, ecx, edx);
+    if (!(ebx & (1u << 2))) return 0;   // SGX not supported
+
+    uint64_t total = 0;
+    for (unsigned int subleaf = 2; subleaf < 2 + 64; subleaf++) {
+        __cpuid_count(0x12, subleaf, eax, ebx, ecx, edx);
+        if ((eax & 0xF) != 1) break;    // no more valid sections
+        uint64_t size = (static_cast<uint64_t>(edx & 0xFFFFF) << 32) | (ecx & 0xFFFFF000u);
+        total += size;
+    }
+    return total;
+}
@@ -0,0 +1,13 @@
+// app/epc_info.h - EPC size as reported by CPUID leaf 0x12
+#ifndef EPC_INFO_H
+#define EPC_INFO_H
+
+#include <cstdint>
+
+// Sum of all EPC sections enumerated by CPUID.(EAX=12H, ECX>=2), or 0 when
+// the CPU reports no SGX or no EPC (e.g. simulation on non-SGX hardware).
+// This is the raw EPC; the usable part is smaller by the EPCM and other
+// reserved pages.
+uint64_t detect_epc_bytes();
+
+#endif // EPC_INFO_H
@@ -0,0 +1,27 @@
+// app/file_ring.cpp
+#include "file_ring.h"
+#include <cstdlib>
+#include <cstring>
+
+FileRing g_file_ring;
+
+bool FileRing::allocate(size_t slot_count, size_t slot_size) {
+    release();
+    if (slot_count == 0 || slot_size == 0) return false;
+
+    void* memory = nullptr;
+    if (posix_memalign(&memory, 4096, slot_count * slot_size) != 0) return false;
+    memset(memory, 0, slot_count * slot_size);
+
+    data_ = static_cast<uint8_t*>(memory);
+    slot_count_ = slot_count;
+    slot_size_ = slot_size;
+    return true;
+}
+
+void FileRing::release() {
+    free(data_);
+    data_ = nullptr;
+    slot_count_ = 0;
+    slot_size_ = 0;
+}
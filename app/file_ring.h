@@ -0,0 +1,35 @@
+// app/file_ring.h - Untrusted slot ring shared with the enclave as user_check memory
+#ifndef FILE_RING_H
+#define FILE_RING_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Page-aligned block of slot_count fixed-size slots. The enclave registers
+// it once (ecall_register_file_ring) and picks the slot for every read;
+// ocall_ring_read_file fills that slot in place, so file data reaches the
+// enclave without passing through an edger8r [out] copy.
+class FileRing {
+public:
+    FileRing() : data_(nullptr), slot_count_(0), slot_size_(0) {}
+    ~FileRing() { release(); }
+
+    bool allocate(size_t slot_count, size_t slot_size);
+    void release();
+
+    uint8_t* data() const { return data_; }
+    size_t slot_count() const { return slot_count_; }
+    size_t slot_size() const { return slot_size_; }
+    uint8_t* slot(size_t index) const {
+        return index < slot_count_ ? data_ + index * slot_size_ : nullptr;
+    }
+
+private:
+    uint8_t* data_;
+    size_t slot_count_;
+    size_t slot_size_;
+};
+
+extern FileRing g_file_ring;
+
+#endif // FILE_RING_H
@@ -0,0 +1,11 @@
+// app/file_ring_types.h - Geometry limits for the user_check file ring
+#ifndef FILE_RING_TYPES_H
+#define FILE_RING_TYPES_H
+
+#define FILE_RING_DEFAULT_SLOTS 8
+#define FILE_RING_MAX_SLOTS 64
+// Also bounds the marshalled comparison path, whose [out] buffer lives on
+// the untrusted stack
+#define FILE_RING_MAX_SLOT_SIZE (1024 * 1024)
+
+#endif // FILE_RING_TYPES_H
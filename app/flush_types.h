@@ -0,0 +1,16 @@
+// app/flush_types.h - Cache flush strategies used by mitigations::cache_flush
+#ifndef FLUSH_TYPES_H
+#define FLUSH_TYPES_H
+
+#define FLUSH_AUTO (-1)         // clflushopt when available, else clflush
+#define FLUSH_CLFLUSH 0         // clflush per line + mfence per call (original)
+#define FLUSH_CLFLUSHOPT 1      // queued, merged, clflushopt + one sfence
+#define FLUSH_CLWB 2            // as CLFLUSHOPT but writes back without evicting
+#define FLUSH_STRATEGY_COUNT 3
+
+// Distinct line ranges queued per TCS before the queue drains early
+#define FLUSH_QUEUE_RANGES 16
+
+#define FLUSH_BENCH_MAX_BYTES (16 * 1024 * 1024)
+
+#endif // FLUSH_TYPES_H
@@ -0,0 +1,12 @@
+// app/hardening_types.h - Where speculation barriers go in enclave loops
+#ifndef HARDENING_TYPES_H
+#define HARDENING_TYPES_H
+
+#define HARDENING_LFENCE 0      // barrier every barrier_stride iterations (original)
+#define HARDENING_MASK 1        // index masking at bounds checks, barriers at trust boundaries only
+
+// Loop iterations between barriers under HARDENING_LFENCE; a power of two,
+// or 0 for barriers at ECALL entry only
+#define HARDENING_DEFAULT_STRIDE 64
+
+#endif // HARDENING_TYPES_H
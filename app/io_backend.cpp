@@ -0,0 +1,206 @@
+// app/io_backend.cpp
+#include "io_backend.h"
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <unordered_map>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+enum class Kind {
+    Stdio,
+    Pread,
+    Mmap,
+    Direct
+};
+
+const size_t DIRECT_ALIGNMENT = 4096;
+
+Kind g_kind = Kind::Stdio;
+// Bumped by forget(); thread caches built under an older value are stale
+std::atomic<unsigned> g_generation(0);
+
+struct CachedFile {
+    Kind kind;
+    int fd = -1;
+    void* map = nullptr;
+    size_t map_size = 0;
+
+    explicit CachedFile(Kind k) : kind(k) {}
+    ~CachedFile() {
+        if (map) munmap(map, map_size);
+        if (fd >= 0) ::close(fd);
+    }
+};
+
+// Failed opens stay cached (fd == -1) so the error is reported once and
+// later calls return 0 without retrying.
+CachedFile* open_cached(const char* filename, Kind kind) {
+    std::unique_ptr<CachedFile> file(new CachedFile(kind));
+    int flags = O_RDONLY | O_CLOEXEC;
+    if (kind == Kind::Direct) flags |= O_DIRECT;
+
+    file->fd = ::open(filename, flags);
+    if (file->fd >= 0 && kind == Kind::Mmap) {
+        struct stat st;
+        bool sized = fstat(file->fd, &st) == 0 && st.st_size > 0;
+        if (sized) {
+            void* map = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE,
+                             file->fd, 0);
+            if (map != MAP_FAILED) {
+                file->map = map;
+                file->map_size = static_cast<size_t>(st.st_size);
+            } else {
+                std::cerr << "io backend mmap: cannot map " << filename << ": " << strerror(errno) << "\n";
+            }
+        }
+        ::close(file->fd);
+        file->fd = -1;
+    } else if (file->fd < 0) {
+        std::cerr << "io backend " << io_backend::name() << ": cannot open " << filename << ": "
+                  << strerror(errno) << "\n";
+    }
+    return file.release();
+}
+
+struct FileCache {
+    std::unordered_map<std::string, std::unique_ptr<CachedFile>> files;
+    // Benchmarks read the same file over and over; skip the hash lookup then
+    std::string last_name;
+    CachedFile* last = nullptr;
+    unsigned generation = 0;
+
+    CachedFile* lookup(const char* filename, Kind kind) {
+        unsigned current = g_generation.load(std::memory_order_acquire);
+        if (current != generation) {
+            clear();
+            generation = current;
+        }
+        if (last && last->kind == kind && last_name == filename) return last;
+
+        std::unique_ptr<CachedFile>& entry = files[filename];
+        if (!entry || entry->kind != kind) {
+            entry.reset(open_cached(filename, kind));
+        }
+        last_name = filename;
+        last = entry.get();
+        return last;
+    }
+
+    void erase(const char* filename) {
+        if (last_name == filename) clear_last();
+        files.erase(filename);
+    }
+
+    void clear() {
+        clear_last();
+        files.clear();
+    }
+
+    void clear_last() {
+        last_name.clear();
+        last = nullptr;
+    }
+};
+
+struct BounceBuffer {
+    void* data = nullptr;
+    size_t size = 0;
+
+    ~BounceBuffer() { free(data); }
+
+    bool reserve(size_t n) {
+        if (n <= size) return true;
+        void* memory = nullptr;
+        if (posix_memalign(&memory, DIRECT_ALIGNMENT, n) != 0) return false;
+        free(data);
+        data = memory;
+        size = n;
+        return true;
+    }
+};
+
+thread_local FileCache t_cache;
+thread_local BounceBuffer t_bounce;
+
+size_t read_stdio(const char* filename, char* buf, size_t buf_len) {
+    FILE* file = fopen(filename, "rb");
+    if (!file) return 0;
+    size_t bytes_read = fread(buf, 1, buf_len, file);
+    fclose(file);
+    return bytes_read;
+}
+
+size_t read_pread(int fd, char* buf, size_t buf_len) {
+    ssize_t n = pread(fd, buf, buf_len, 0);
+    return n > 0 ? static_cast<size_t>(n) : 0;
+}
+
+size_t read_mmap(const CachedFile& file, char* buf, size_t buf_len) {
+    size_t n = buf_len < file.map_size ? buf_len : file.map_size;
+    memcpy(buf, file.map, n);
+    return n;
+}
+
+// O_DIRECT needs an aligned buffer, offset and length, so read whole pages
+// into the bounce buffer and copy out the requested prefix
+size_t read_direct(int fd, char* buf, size_t buf_len) {
+    size_t aligned = (buf_len + DIRECT_ALIGNMENT - 1) & ~(DIRECT_ALIGNMENT - 1);
+    if (!t_bounce.reserve(aligned)) return 0;
+
+    ssize_t n = pread(fd, t_bounce.data, aligned, 0);
+    if (n <= 0) return 0;
+    size_t bytes = static_cast<size_t>(n) < buf_len ? static_cast<size_t>(n) : buf_len;
+    memcpy(buf, t_bounce.data, bytes);
+    return bytes;
+}
+
+} // namespace
+
+namespace io_backend {
+
+bool select(const std::string& backend) {
+    if (backend == "stdio") g_kind = Kind::Stdio;
+    else if (backend == "pread") g_kind = Kind::Pread;
+    else if (backend == "mmap") g_kind = Kind::Mmap;
+    else if (backend == "direct") g_kind = Kind::Direct;
+    else return false;
+    return true;
+}
+
+const char* name() {
+    switch (g_kind) {
+        case Kind::Pread: return "pread";
+        case Kind::Mmap: return "mmap";
+        case Kind::Direct: return "direct";
+        default: return "stdio";
+    }
+}
+
+void forget(const char* filename) {
+    t_cache.erase(filename);
+    g_generation.fetch_add(1, std::memory_order_release);
+}
+
+size_t read_file(const char* filename, char* buf, size_t buf_len) {
+    Kind kind = g_kind;
+    if (kind == Kind::Stdio) return read_stdio(filename, buf, buf_len);
+
+    CachedFile* file = t_cache.lookup(filename, kind);
+    switch (kind) {
+        case Kind::Pread: return file->fd >= 0 ? read_pread(file->fd, buf, buf_len) : 0;
+        case Kind::Mmap: return file->map ? read_mmap(*file, buf, buf_len) : 0;
+        case Kind::Direct: return file->fd >= 0 ? read_direct(file->fd, buf, buf_len) : 0;
+        default: return 0;
+    }
+}
+
+} // namespace io_backend
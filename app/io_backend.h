@@ -0,0 +1,29 @@
+// app/io_backend.h - Untrusted file I/O strategies behind the read OCALLs
+#ifndef IO_BACKEND_H
+#define IO_BACKEND_H
+
+#include <cstddef>
+#include <string>
+
+// Every file-reading OCALL goes through the selected backend, so file
+// benchmarks can separate OS I/O cost from transition and mitigation cost:
+//  - stdio:  fopen/fread/fclose on every call (the original behaviour)
+//  - pread:  descriptor opened once per thread and file, pread at offset 0
+//  - mmap:   file mapped once per thread and file, served with memcpy
+//  - direct: cached O_DIRECT descriptor that bypasses the page cache,
+//            read through a page-aligned bounce buffer
+// Caches are thread-local, so --threads runs never contend on them. They
+// live until the thread exits or a file is rewritten: every path that
+// rewrites a file calls forget() first, since a mapping or size cached
+// from the old file would be stale (and an mmap of a truncated file
+// faults with SIGBUS).
+namespace io_backend {
+    bool select(const std::string& name);
+    const char* name();
+    size_t read_file(const char* filename, char* buf, size_t buf_len);
+    // Drops filename from the calling thread's cache at once; other threads
+    // discard their whole cache on their next read
+    void forget(const char* filename);
+}
+
+#endif // IO_BACKEND_H
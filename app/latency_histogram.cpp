@@ -0,0 +1,60 @@
+// app/latency_histogram.cpp
+#include "latency_histogram.h"
+#include <cmath>
+#include <cstring>
+
+void LatencyHistogram::reset() {
+    memset(counts_, 0, sizeof(counts_));
+    total_count_ = 0;
+    min_ = UINT64_MAX;
+    max_ = 0;
+    sum_ = 0.0;
+    sum_sq_ = 0.0;
+}
+
+uint64_t LatencyHistogram::value_at(size_t index) {
+    if (index < SUB_BUCKET_COUNT) return index;
+    size_t offset = index - SUB_BUCKET_COUNT;
+    int shift = static_cast<int>(offset / HALF_COUNT) + 1;
+    uint64_t lower = (HALF_COUNT + offset % HALF_COUNT) << shift;
+    // Report the midpoint of the bucket's equivalent-value range
+    return lower + ((1ULL << shift) >> 1);
+}
+
+uint64_t LatencyHistogram::percentile(double pct) const {
+    if (total_count_ == 0) return 0;
+
+    uint64_t target = static_cast<uint64_t>(
+        std::ceil((pct / 100.0) * static_cast<double>(total_count_)));
+    if (target == 0) target = 1;
+
+    uint64_t seen = 0;
+    for (size_t i = 0; i < BUCKET_COUNT; i++) {
+        seen += counts_[i];
+        if (seen >= target) {
+            uint64_t value = value_at(i);
+            if (value < min_) return min_;
+            if (value > max_) return max_;
+            return value;
+        }
+    }
+    return max_;
+}
+
+LatencyStats LatencyHistogram::stats() const {
+    LatencyStats s = {0, 0, 0, 0, 0, 0, 0.0};
+    if (total_count_ == 0) return s;
+
+    double n = static_cast<double>(total_count_);
+    double mean = sum_ / n;
+    double variance = (sum_sq_ / n) - (mean * mean);
+
+    s.min_cycles = min_;
+    s.p50_cycles = percentile(50.0);
+    s.p90_cycles = percentile(90.0);
+    s.p99_cycles = percentile(99.0);
+    s.p999_cycles = percentile(99.9);
+    s.max_cycles = max_;
+    s.stddev_cycles = variance > 0.0 ? std::sqrt(variance) : 0.0;
+    return s;
+}
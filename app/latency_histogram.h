@@ -0,0 +1,68 @@
+// app/latency_histogram.h
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include <cstddef>
+#include <cstdint>
+
+struct LatencyStats {
+    uint64_t min_cycles;
+    uint64_t p50_cycles;
+    uint64_t p90_cycles;
+    uint64_t p99_cycles;
+    uint64_t p999_cycles;
+    uint64_t max_cycles;
+    double stddev_cycles;
+};
+
+// Log-bucketed (HDR-style) histogram of per-operation cycle counts.
+// Values below SUB_BUCKET_COUNT are stored exactly; above that every
+// power-of-two range is split into HALF_COUNT linear sub-buckets, which
+// bounds the relative error of any reported percentile to ~1.6%.
+// All storage is inline so record() never allocates inside a timed loop.
+class LatencyHistogram {
+public:
+    static const int SUB_BUCKET_BITS = 7;
+    static const uint64_t SUB_BUCKET_COUNT = 1ULL << SUB_BUCKET_BITS;
+    static const uint64_t HALF_COUNT = SUB_BUCKET_COUNT / 2;
+    static const size_t BUCKET_COUNT =
+        SUB_BUCKET_COUNT + (64 - SUB_BUCKET_BITS) * HALF_COUNT;
+
+    LatencyHistogram() { reset(); }
+
+    void reset();
+
+    inline void record(uint64_t value) {
+        counts_[index_of(value)]++;
+        total_count_++;
+        if (value < min_) min_ = value;
+        if (value > max_) max_ = value;
+        double v = static_cast<double>(value);
+        sum_ += v;
+        sum_sq_ += v * v;
+    }
+
+    uint64_t count() const { return total_count_; }
+    uint64_t percentile(double pct) const;
+    LatencyStats stats() const;
+
+private:
+    static inline size_t index_of(uint64_t value) {
+        if (value < SUB_BUCKET_COUNT) return static_cast<size_t>(value);
+        int msb = 63 - __builtin_clzll(value);
+        int shift = msb - (SUB_BUCKET_BITS - 1);
+        return static_cast<size_t>(SUB_BUCKET_COUNT +
+            static_cast<uint64_t>(shift - 1) * HALF_COUNT + ((value >> shift) - HALF_COUNT));
+    }
+
+    static uint64_t value_at(size_t index);
+
+    uint64_t counts_[BUCKET_COUNT];
+    uint64_t total_count_;
+    uint64_t min_;
+    uint64_t max_;
+    double sum_;
+    double sum_sq_;
+};
+
+#endif // LATENCY_HISTOGRAM_H
@@ -0,0 +1,15 @@
+// app/marshal_types.h - Buffer directions for the marshalling sweep
+#ifndef MARSHAL_TYPES_H
+#define MARSHAL_TYPES_H
+
+#define MARSHAL_IN 0
+#define MARSHAL_OUT 1
+#define MARSHAL_INOUT 2
+#define MARSHAL_USER_CHECK 3
+#define MARSHAL_DIRECTION_COUNT 4
+
+// [in]/[out] OCALL buffers are placed on the untrusted stack by
+// sgx_ocalloc, so OCALL payloads stay below its 8 MB default
+#define MARSHAL_MAX_OCALL_SIZE (4 * 1024 * 1024)
+
+#endif // MARSHAL_TYPES_H
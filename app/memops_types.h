@@ -0,0 +1,17 @@
+// app/memops_types.h - Implementations of the constant-time copy/zero primitives
+#ifndef MEMOPS_TYPES_H
+#define MEMOPS_TYPES_H
+
+// Store width used by mitigations::raw::volatile_copy/volatile_zero
+#define MEMOPS_AUTO (-1)        // widest the CPU and enclave support
+#define MEMOPS_BYTE 0
+#define MEMOPS_SSE2 1
+#define MEMOPS_AVX2 2
+#define MEMOPS_LEVEL_COUNT 3
+
+#define MEMOPS_OP_COPY 0
+#define MEMOPS_OP_ZERO 1
+
+#define MEMOPS_MAX_BYTES (16 * 1024 * 1024)
+
+#endif // MEMOPS_TYPES_H
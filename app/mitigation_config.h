@@ -1,7 +1,10 @@
 #ifndef MITIGATION_CONFIG_H
 #define MITIGATION_CONFIG_H
 
+#include "flush_types.h"
+#include "hardening_types.h"
 #include <stdbool.h>
+#include <stdint.h>
 
 typedef struct {
     // Individual speculation barriers
@@ -14,6 +17,18 @@ typedef struct {
     bool memory_barriers;
     // bool disable_hyperthreading;
 
+    // Dispatch to compile-time specialized workloads instead of checking
+    // the flags above at every mitigation site
+    bool static_dispatch;
+
+    // How cache_flushing evicts lines, a FLUSH_* strategy
+    int flush_strategy;
+
+    // How lfence_barrier protects bounds-dependent loops, a HARDENING_*
+    // mode, and the loop stride used by HARDENING_LFENCE
+    int hardening;
+    uint32_t barrier_stride;
+
 } MitigationConfig;
 
 static inline void init_mitigation_config(MitigationConfig* config) {
@@ -24,6 +39,10 @@ static inline void init_mitigation_config(MitigationConfig* config) {
         config->constant_time_ops = false;
         config->memory_barriers = false;
         // config->disable_hyperthreading = false;
+        config->static_dispatch = false;
+        config->flush_strategy = FLUSH_CLFLUSH;
+        config->hardening = HARDENING_LFENCE;
+        config->barrier_stride = HARDENING_DEFAULT_STRIDE;
     }
 }
 
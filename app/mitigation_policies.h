@@ -0,0 +1,164 @@
+// mitigation_policies.h
+#ifndef MITIGATION_POLICIES_H
+#define MITIGATION_POLICIES_H
+
+#include "mitigations.h"
+#include <string.h>
+
+extern MitigationConfig g_enclave_config;
+
+// Policy types give workload templates one interface over two ways of
+// applying mitigations:
+//  - StaticPolicy fixes every switch at compile time, so disabled
+//    mitigations compile to nothing and barriers can be scheduled freely.
+//    StaticPolicy<false, false, false, false, false> is the zero-overhead
+//    baseline.
+//  - RuntimePolicy forwards to the flag-checking helpers in mitigations.h,
+//    i.e. the original behaviour.
+namespace mitigations {
+    // Barrier placement is a runtime choice in both policies (see
+    // hardening_types.h). Loop iteration i takes a barrier when it is a
+    // multiple of barrier_stride * scale under HARDENING_LFENCE; loops with
+    // no bounds-dependent loads pass scale 2. HARDENING_MASK has no loop
+    // barriers: bounds-dependent indices go through index_nospec instead
+    // and boundary_barrier() fences where untrusted data enters.
+    inline bool barrier_due(size_t i, size_t scale) {
+        const size_t stride = g_enclave_config.barrier_stride * scale;
+        return g_enclave_config.hardening == HARDENING_LFENCE && stride != 0 &&
+               (i & (stride - 1)) == 0;
+    }
+
+    inline bool masking_enabled() {
+        return g_enclave_config.hardening == HARDENING_MASK;
+    }
+
+    template <bool Lfence, bool Mfence, bool Cache, bool ConstantTime, bool Memory>
+    struct StaticPolicy {
+        static constexpr bool lfence_enabled() { return Lfence; }
+        static constexpr bool mfence_enabled() { return Mfence; }
+        static constexpr bool cache_enabled() { return Cache; }
+        static constexpr bool constant_time_enabled() { return ConstantTime; }
+        static constexpr bool memory_enabled() { return Memory; }
+
+        static inline void lfence_barrier() {
+            if (Lfence) raw::lfence();
+        }
+
+        static inline void mfence_barrier() {
+            if (Mfence) raw::mfence();
+        }
+
+        static inline void speculation_barrier() {
+            lfence_barrier();
+            mfence_barrier();
+        }
+
+        static inline void loop_barrier(size_t i, size_t scale = 1) {
+            if ((Lfence || Mfence) && barrier_due(i, scale)) speculation_barrier();
+        }
+
+        static inline void boundary_barrier() {
+            if ((Lfence || Mfence) && masking_enabled()) speculation_barrier();
+        }
+
+        static inline size_t index_nospec(size_t index, size_t size) {
+            return Lfence && masking_enabled() ? raw::index_nospec(index, size) : index;
+        }
+
+        static inline void cache_flush(const void* addr, size_t size) {
+            if (Cache) raw::cache_flush(addr, size);
+        }
+
+        // Issues the queued flushes; workloads call it before every OCALL
+        static inline void flush_boundary() {
+            if (Cache) raw::flush_drain();
+        }
+
+        static inline void memory_barrier() {
+            if (Memory) raw::mfence();
+        }
+
+        static inline void constant_time_memcpy(void* dest, const void* src, size_t n) {
+            if (ConstantTime) {
+                raw::volatile_copy(dest, src, n);
+            } else {
+                memcpy(dest, src, n);
+            }
+        }
+
+        static inline void secure_memzero(void* ptr, size_t len) {
+            if (!ConstantTime) {
+                memset(ptr, 0, len);
+                return;
+            }
+            cache_flush(ptr, len);
+            raw::volatile_zero(ptr, len);
+            cache_flush(ptr, len);
+        }
+    };
+
+    typedef StaticPolicy<false, false, false, false, false> NoMitigations;
+
+    // Calls P::flush_boundary() on scope exit, so a workload's queued
+    // flushes are issued however it returns. Compiles to nothing for
+    // policies without cache flushing.
+    template <class P>
+    struct FlushBoundary {
+        FlushBoundary() {}
+        ~FlushBoundary() { P::flush_boundary(); }
+
+    private:
+        FlushBoundary(const FlushBoundary&);
+        FlushBoundary& operator=(const FlushBoundary&);
+    };
+
+    struct RuntimePolicy {
+        static inline bool lfence_enabled() { return g_enclave_config.lfence_barrier; }
+        static inline bool mfence_enabled() { return g_enclave_config.mfence_barrier; }
+        static inline bool cache_enabled() { return g_enclave_config.cache_flushing; }
+        static inline bool constant_time_enabled() { return g_enclave_config.constant_time_ops; }
+        static inline bool memory_enabled() { return g_enclave_config.memory_barriers; }
+
+        static inline void lfence_barrier() { mitigations::lfence_barrier(); }
+        static inline void mfence_barrier() { mitigations::mfence_barrier(); }
+
+        static inline void speculation_barrier() {
+            mitigations::lfence_barrier();
+            mitigations::mfence_barrier();
+        }
+
+        static inline void loop_barrier(size_t i, size_t scale = 1) {
+            if (barrier_due(i, scale)) speculation_barrier();
+        }
+
+        static inline void boundary_barrier() {
+            if (masking_enabled()) speculation_barrier();
+        }
+
+        static inline size_t index_nospec(size_t index, size_t size) {
+            return lfence_enabled() && masking_enabled() ? raw::index_nospec(index, size) : index;
+        }
+
+        static inline void cache_flush(const void* addr, size_t size) {
+            mitigations::cache_flush(addr, size);
+        }
+
+        // Flushes are only queued while cache_flushing is on, and the
+        // config cannot change inside an ECALL
+        static inline void flush_boundary() {
+            if (cache_enabled()) raw::flush_drain();
+        }
+
+        static inline void memory_barrier() { mitigations::memory_barrier(); }
+
+        static inline void constant_time_memcpy(void* dest, const void* src, size_t n) {
+            mitigations::constant_time_memcpy(dest, src, n);
+        }
+
+        static inline void secure_memzero(void* ptr, size_t len) {
+            mitigations::secure_memzero(ptr, len);
+        }
+    };
+}
+
+#endif // MITIGATION_POLICIES_H
@@ -1,6 +1,8 @@
 // mitigations.cpp
 
 #include "mitigations.h"
+#include "sgx_cpuid.h"
+#include "sgx_utils.h"
 #include <string.h>
 
 MitigationConfig g_enclave_config;
@@ -9,35 +11,308 @@ void set_enclave_config(const MitigationConfig* config) {
     if (config) {
         g_enclave_config = *config;
     }
+    // The config crosses the ECALL boundary: a stride that is not a power
+    // of two would break the masked stride test in barrier_due()
+    uint32_t stride = g_enclave_config.barrier_stride;
+    if ((stride & (stride - 1)) != 0) {
+        g_enclave_config.barrier_stride = HARDENING_DEFAULT_STRIDE;
+    }
+    if (g_enclave_config.hardening != HARDENING_MASK) {
+        g_enclave_config.hardening = HARDENING_LFENCE;
+    }
+
+    // The first config message is the earliest point where the CPUID
+    // OCALL can be made, so the default copy/zero width is picked here
+    static bool memops_selected = false;
+    if (!memops_selected) {
+        mitigations::raw::select_memops(MEMOPS_AUTO);
+        memops_selected = true;
+    }
+    mitigations::raw::select_flush(g_enclave_config.flush_strategy);
 }
 
 namespace mitigations {
-    const size_t CACHE_LINE_SIZE = 64;
+    const uintptr_t CACHE_LINE_SIZE = 64;
+
+    namespace raw {
+        // CPUID.(EAX=7,ECX=0):EBX, fetched once through sgx_cpuidex. The
+        // host answers, so a lying host can at worst make the enclave
+        // fault on an unsupported instruction, not leak data.
+        static int cpuid7_ebx() {
+            static bool queried = false;
+            static int ebx = 0;
+            if (queried) return ebx;
+
+            int leaf0[4] = {0, 0, 0, 0};
+            int leaf7[4] = {0, 0, 0, 0};
+            if (sgx_cpuidex(leaf0, 0, 0) == SGX_SUCCESS && leaf0[0] >= 7 &&
+                sgx_cpuidex(leaf7, 7, 0) == SGX_SUCCESS) {
+                ebx = leaf7[1];
+            }
+            queried = true;
+            return ebx;
+        }
+
+        // Flush engine. With FLUSH_CLFLUSH every call flushes at once and
+        // ends with an mfence, as before. The other strategies queue
+        // line-aligned ranges per TCS, merging overlapping and adjacent
+        // ones, and flush_drain() issues each line once followed by a
+        // single sfence. The queue drains at every trust boundary: before
+        // each OCALL (the policies' flush_boundary()) and when each ECALL
+        // returns (FlushBoundary or FlushScope), so requests only merge
+        // between boundaries and no flush is deferred past untrusted code.
+        struct FlushRange {
+            uintptr_t begin;
+            uintptr_t end;
+        };
+
+        static int g_flush_strategy = FLUSH_CLFLUSH;
+        static __thread FlushRange t_flush_queue[FLUSH_QUEUE_RANGES];
+        static __thread unsigned t_flush_count = 0;
+
+        static void flush_lines(uintptr_t begin, uintptr_t end, int strategy) {
+            for (uintptr_t line = begin; line < end; line += CACHE_LINE_SIZE) {
+                char* p = reinterpret_cast<char*>(line);
+                switch (strategy) {
+                    case FLUSH_CLWB: __asm__ volatile ("clwb %0" : "+m" (*p)); break;
+                    case FLUSH_CLFLUSHOPT: __asm__ volatile ("clflushopt %0" : "+m" (*p)); break;
+                    default: __asm__ volatile ("clflush %0" : "+m" (*p)); break;
+                }
+            }
+        }
+
+        static void flush_fence(int strategy) {
+            if (strategy == FLUSH_CLFLUSH) {
+                __asm__ volatile ("mfence" ::: "memory");
+            } else {
+                __asm__ volatile ("sfence" ::: "memory");
+            }
+        }
+
+        bool flush_supported(int strategy) {
+            switch (strategy) {
+                case FLUSH_CLFLUSH: return true;
+                case FLUSH_CLFLUSHOPT: return (cpuid7_ebx() & (1 << 23)) != 0;
+                case FLUSH_CLWB: return (cpuid7_ebx() & (1 << 24)) != 0;
+                default: return false;
+            }
+        }
+
+        int select_flush(int strategy) {
+            if (strategy == FLUSH_AUTO) {
+                strategy = flush_supported(FLUSH_CLFLUSHOPT) ? FLUSH_CLFLUSHOPT : FLUSH_CLFLUSH;
+            } else if (!flush_supported(strategy)) {
+                strategy = FLUSH_CLFLUSH;
+            }
+            if (strategy != g_flush_strategy) {
+                flush_drain();
+                g_flush_strategy = strategy;
+            }
+            return strategy;
+        }
+
+        int flush_strategy() {
+            return g_flush_strategy;
+        }
+
+        void flush_now(const void* addr, size_t size) {
+            if (size == 0) return;
+            uintptr_t begin = reinterpret_cast<uintptr_t>(addr) & ~(CACHE_LINE_SIZE - 1);
+            uintptr_t end = reinterpret_cast<uintptr_t>(addr) + size;
+            flush_lines(begin, end, g_flush_strategy);
+            flush_fence(g_flush_strategy);
+        }
+
+        void flush_drain() {
+            if (t_flush_count == 0) return;
+            for (unsigned i = 0; i < t_flush_count; i++) {
+                flush_lines(t_flush_queue[i].begin, t_flush_queue[i].end, g_flush_strategy);
+            }
+            t_flush_count = 0;
+            flush_fence(g_flush_strategy);
+        }
+
+        void cache_flush(const void* addr, size_t size) {
+            if (g_flush_strategy == FLUSH_CLFLUSH) {
+                flush_now(addr, size);
+                return;
+            }
+            if (size == 0) return;
+
+            uintptr_t begin = reinterpret_cast<uintptr_t>(addr) & ~(CACHE_LINE_SIZE - 1);
+            uintptr_t end = (reinterpret_cast<uintptr_t>(addr) + size + CACHE_LINE_SIZE - 1) &
+                            ~(CACHE_LINE_SIZE - 1);
+
+            // Absorb every queued range this one overlaps or touches; the
+            // union may reach further ranges, so rescan after each merge
+            for (unsigned i = 0; i < t_flush_count;) {
+                FlushRange& range = t_flush_queue[i];
+                if (range.begin <= end && begin <= range.end) {
+                    if (range.begin < begin) begin = range.begin;
+                    if (range.end > end) end = range.end;
+                    range = t_flush_queue[--t_flush_count];
+                    i = 0;
+                } else {
+                    i++;
+                }
+            }
+
+            if (t_flush_count == FLUSH_QUEUE_RANGES) {
+                flush_drain();
+            }
+            t_flush_queue[t_flush_count].begin = begin;
+            t_flush_queue[t_flush_count].end = end;
+            t_flush_count++;
+        }
+
+        // Until the first config message arrives only byte stores are used
+        static int g_memops_level = MEMOPS_BYTE;
+        static int g_memops_supported = -1;
+
+        const size_t BLOCK_SIZE = 64;
+
+        static void byte_copy(volatile unsigned char* d, const volatile unsigned char* s, size_t n) {
+            for (size_t i = 0; i < n; i++) {
+                d[i] = s[i];
+            }
+        }
+
+        static void byte_zero(volatile unsigned char* p, size_t len) {
+            for (size_t i = 0; i < len; i++) {
+                p[i] = 0;
+            }
+        }
+
+        // The block loops are inline asm rather than intrinsics: the
+        // enclave is built with -nostdinc, and asm with a "memory" clobber
+        // is also the compiler barrier that keeps the stores in place.
+        static void sse2_copy(unsigned char* d, const unsigned char* s, size_t blocks) {
+            for (size_t b = 0; b < blocks; b++, d += BLOCK_SIZE, s += BLOCK_SIZE) {
+                __asm__ volatile (
+                    "movdqu   (%1), %%xmm0\n\t"
+                    "movdqu 16(%1), %%xmm1\n\t"
+                    "movdqu 32(%1), %%xmm2\n\t"
+                    "movdqu 48(%1), %%xmm3\n\t"
+                    "movdqu %%xmm0,   (%0)\n\t"
+                    "movdqu %%xmm1, 16(%0)\n\t"
+                    "movdqu %%xmm2, 32(%0)\n\t"
+                    "movdqu %%xmm3, 48(%0)"
+                    : : "r" (d), "r" (s) : "xmm0", "xmm1", "xmm2", "xmm3", "memory");
+            }
+        }
+
+        static void sse2_zero(unsigned char* p, size_t blocks) {
+            for (size_t b = 0; b < blocks; b++, p += BLOCK_SIZE) {
+                __asm__ volatile (
+                    "pxor   %%xmm0, %%xmm0\n\t"
+                    "movdqu %%xmm0,   (%0)\n\t"
+                    "movdqu %%xmm0, 16(%0)\n\t"
+                    "movdqu %%xmm0, 32(%0)\n\t"
+                    "movdqu %%xmm0, 48(%0)"
+                    : : "r" (p) : "xmm0", "memory");
+            }
+        }
+
+        static void avx2_copy(unsigned char* d, const unsigned char* s, size_t blocks) {
+            for (size_t b = 0; b < blocks; b++, d += BLOCK_SIZE, s += BLOCK_SIZE) {
+                __asm__ volatile (
+                    "vmovdqu   (%1), %%ymm0\n\t"
+                    "vmovdqu 32(%1), %%ymm1\n\t"
+                    "vmovdqu %%ymm0,   (%0)\n\t"
+                    "vmovdqu %%ymm1, 32(%0)"
+                    : : "r" (d), "r" (s) : "xmm0", "xmm1", "memory");
+            }
+            __asm__ volatile ("vzeroupper" : : : "memory");
+        }
+
+        static void avx2_zero(unsigned char* p, size_t blocks) {
+            for (size_t b = 0; b < blocks; b++, p += BLOCK_SIZE) {
+                __asm__ volatile (
+                    "vpxor   %%ymm0, %%ymm0, %%ymm0\n\t"
+                    "vmovdqu %%ymm0,   (%0)\n\t"
+                    "vmovdqu %%ymm0, 32(%0)"
+                    : : "r" (p) : "xmm0", "memory");
+            }
+            __asm__ volatile ("vzeroupper" : : : "memory");
+        }
+
+        // Whole 64-byte blocks go through the selected width, the tail
+        // through byte stores. The split depends only on n.
+        void volatile_copy(void* dest, const void* src, size_t n) {
+            unsigned char* d = static_cast<unsigned char*>(dest);
+            const unsigned char* s = static_cast<const unsigned char*>(src);
+            size_t blocks = n / BLOCK_SIZE;
+            size_t head = blocks * BLOCK_SIZE;
+
+            switch (g_memops_level) {
+                case MEMOPS_AVX2: avx2_copy(d, s, blocks); break;
+                case MEMOPS_SSE2: sse2_copy(d, s, blocks); break;
+                default: head = 0; break;
+            }
+            byte_copy(d + head, s + head, n - head);
+        }
+
+        void volatile_zero(void* ptr, size_t len) {
+            unsigned char* p = static_cast<unsigned char*>(ptr);
+            size_t blocks = len / BLOCK_SIZE;
+            size_t head = blocks * BLOCK_SIZE;
+
+            switch (g_memops_level) {
+                case MEMOPS_AVX2: avx2_zero(p, blocks); break;
+                case MEMOPS_SSE2: sse2_zero(p, blocks); break;
+                default: head = 0; break;
+            }
+            byte_zero(p + head, len - head);
+        }
+
+        // AVX2 needs the CPUID feature bit and YMM state (XFRM bit 2) enabled
+        // for this enclave
+        int memops_supported() {
+            if (g_memops_supported >= 0) return g_memops_supported;
+
+            int level = MEMOPS_SSE2;        // part of x86-64
+            const sgx_report_t* report = sgx_self_report();
+            const uint64_t xfrm_sse_avx = 0x6;
+            if ((cpuid7_ebx() & (1 << 5)) != 0 &&
+                report != NULL && (report->body.attributes.xfrm & xfrm_sse_avx) == xfrm_sse_avx) {
+                level = MEMOPS_AVX2;
+            }
+            g_memops_supported = level;
+            return level;
+        }
+
+        int select_memops(int level) {
+            int supported = memops_supported();
+            if (level < 0 || level > supported) level = supported;
+            g_memops_level = level;
+            return level;
+        }
+
+        int memops() {
+            return g_memops_level;
+        }
+    }
 
     void lfence_barrier() {
         if (g_enclave_config.lfence_barrier) {
-            __asm__ volatile ("lfence" ::: "memory");
+            raw::lfence();
         }
     }
 
     void mfence_barrier() {
         if (g_enclave_config.mfence_barrier) {
-            __asm__ volatile ("mfence" ::: "memory");
+            raw::mfence();
         }
     }
 
     void cache_flush(const void* addr, size_t size) {
         if (!g_enclave_config.cache_flushing) return;
-        char* ptr = const_cast<char*>(static_cast<const char*>(addr));
-        for (size_t i = 0; i < size; i += CACHE_LINE_SIZE) {
-            __asm__ volatile ("clflush %0" : "+m" (*(ptr + i)));
-        }
-        __asm__ volatile ("mfence" ::: "memory");
+        raw::cache_flush(addr, size);
     }
 
     void memory_barrier() {
         if (!g_enclave_config.memory_barriers) return;
-        __asm__ volatile ("mfence" ::: "memory");
+        raw::mfence();
     }
 
     void constant_time_memcpy(void* dest, const void* src, size_t n) {
@@ -45,11 +320,7 @@ namespace mitigations {
             memcpy(dest, src, n);
             return;
         }
-        volatile unsigned char* d = static_cast<volatile unsigned char*>(dest);
-        const volatile unsigned char* s = static_cast<const volatile unsigned char*>(src);
-        for (size_t i = 0; i < n; i++) {
-            d[i] = s[i];
-        }
+        raw::volatile_copy(dest, src, n);
     }
 
     void secure_memzero(void* ptr, size_t len) {
@@ -58,10 +329,7 @@ namespace mitigations {
             return;
         }
         cache_flush(ptr, len);
-        volatile unsigned char* p = static_cast<volatile unsigned char*>(ptr);
-        for (size_t i = 0; i < len; i++) {
-            p[i] = 0;
-        }
+        raw::volatile_zero(ptr, len);
         cache_flush(ptr, len);
     }
-}
\ No newline at end of file
+}
@@ -2,6 +2,8 @@
 #ifndef MITIGATIONS_H
 #define MITIGATIONS_H
 
+#include "flush_types.h"
+#include "memops_types.h"
 #include "mitigation_config.h"
 #include <stddef.h>
 #include <stdint.h>
@@ -9,12 +11,71 @@
 void set_enclave_config(const MitigationConfig* config);
 
 namespace mitigations {
+    // Unconditional primitives, shared by the runtime-flag helpers below
+    // and by the compile-time policies in mitigation_policies.h
+    namespace raw {
+        inline void lfence() {
+            __asm__ volatile ("lfence" ::: "memory");
+        }
+
+        inline void mfence() {
+            __asm__ volatile ("mfence" ::: "memory");
+        }
+
+        // Flushes [addr, addr + size) under the selected FLUSH_* strategy:
+        // at once for FLUSH_CLFLUSH, otherwise queued for flush_drain()
+        void cache_flush(const void* addr, size_t size);
+        // Flushes every queued range, then fences once
+        void flush_drain();
+        // Flushes and fences at once, whatever the strategy
+        void flush_now(const void* addr, size_t size);
+        bool flush_supported(int strategy);
+        // Selects a FLUSH_* strategy (FLUSH_AUTO for the best one), falling
+        // back to FLUSH_CLFLUSH if unsupported; returns the one in use
+        int select_flush(int strategy);
+        int flush_strategy();
+
+        // array_index_nospec: index when index < size, otherwise 0, computed
+        // with cmp/sbb so no branch exists for the CPU to mispredict
+        inline size_t index_nospec(size_t index, size_t size) {
+            size_t mask;
+            __asm__ ("cmp %2, %1\n\tsbb %0, %0" : "=r" (mask) : "r" (index), "r" (size) : "cc");
+            return index & mask;
+        }
+
+        // Copy and zero that the compiler can neither elide nor shorten.
+        // They store in fixed-width blocks (see select_memops) and only
+        // branch on the length, never on the data.
+        void volatile_copy(void* dest, const void* src, size_t n);
+        void volatile_zero(void* ptr, size_t len);
+
+        // Highest MEMOPS_* level this CPU and enclave allow
+        int memops_supported();
+        // Selects a MEMOPS_* level (MEMOPS_AUTO for the best one), capped
+        // at memops_supported(); returns the level now in use
+        int select_memops(int level);
+        int memops();
+    }
+
     void lfence_barrier();
     void mfence_barrier();
     void cache_flush(const void* addr, size_t size);
     void memory_barrier();
     void constant_time_memcpy(void* dest, const void* src, size_t n);
     void secure_memzero(void* ptr, size_t len);
+
+    // Drains the calling TCS's flush queue when it goes out of scope.
+    // ECALLs outside policy_dispatch that can queue flushes hold one
+    // (dispatched ones get mitigations::FlushBoundary), so the queue is
+    // empty whenever the TCS is outside the enclave.
+    struct FlushScope {
+        FlushScope() {}
+        ~FlushScope() { raw::flush_drain(); }
+
+    private:
+        FlushScope(const FlushScope&);
+        FlushScope& operator=(const FlushScope&);
+    };
 }
 
-#endif // MITIGATIONS_H
\ No newline at end of file
+#endif // MITIGATIONS_H
@@ -1,9 +1,29 @@
 // app/ocall_handlers.cpp
 #include "enclave_u.h"
+#include "batch_types.h"
+#include "cycle_counter.h"
+#include "file_ring.h"
+#include "io_backend.h"
+#include "latency_histogram.h"
+#include "stream_io.h"
+#include "trace_report.h"
 #include <cstdio>
 #include <cstdlib>
 
+// Set by BenchmarkRunner while a per-op pure_ocall run is in progress;
+// each sample is the gap between two consecutive OCALL entries.
+LatencyHistogram* g_ocall_histogram = nullptr;
+uint64_t g_last_ocall_cycles = 0;
+
 void empty_ocall() {
+    if (g_ocall_histogram) {
+        uint64_t now = CycleCounter::start();
+        if (g_last_ocall_cycles != 0) {
+            g_ocall_histogram->record(now - g_last_ocall_cycles);
+        }
+        g_last_ocall_cycles = now;
+    }
+
     volatile int counter = 0;
     for (int i = 0; i < 100; ++i) {
         counter += i % 123;
@@ -22,24 +42,50 @@ void pong_ocall(int iteration) {
     (void)iteration;
 }
 
+void empty_ocall_switchless() {
+    empty_ocall();
+}
+
+void pong_ocall_switchless(int iteration) {
+    pong_ocall(iteration);
+}
+
 size_t ocall_read_file(const char* filename, char* buf, size_t buf_len) {
-    FILE* file = fopen(filename, "rb");
-    if (!file) return 0;
-    size_t bytes_read = fread(buf, 1, buf_len, file);
-    fclose(file);
-    return bytes_read;
+    return io_backend::read_file(filename, buf, buf_len);
 }
 
-size_t ocall_read_sealed_file(const char* filename, uint8_t* sealed_buf, size_t buf_len) {
-    FILE* file = fopen(filename, "rb");
-    if (!file) return 0;
+size_t ocall_ring_read_file(const char* filename, size_t slot, size_t len) {
+    uint8_t* dest = g_file_ring.slot(slot);
+    if (!dest) return 0;
+    if (len > g_file_ring.slot_size()) len = g_file_ring.slot_size();
+    return ocall_read_file(filename, reinterpret_cast<char*>(dest), len);
+}
 
-    size_t bytes_read = fread(sealed_buf, 1, buf_len, file);
-    fclose(file);
-    return bytes_read;
+size_t ocall_read_file_switchless(const char* filename, char* buf, size_t buf_len) {
+    return ocall_read_file(filename, buf, buf_len);
+}
+
+void pong_ocall_batch(const int* iterations, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        pong_ocall(iterations[i]);
+    }
+}
+
+void ocall_read_files_batch(const batch_request_t* requests, uint64_t* lengths, size_t count,
+                            char* buf, size_t buf_len, size_t slot_size) {
+    for (size_t i = 0; i < count; i++) {
+        lengths[i] = 0;
+        if ((i + 1) * slot_size > buf_len) break;
+        lengths[i] = ocall_read_file(requests[i].filename, buf + i * slot_size, slot_size);
+    }
+}
+
+size_t ocall_read_sealed_file(const char* filename, uint8_t* sealed_buf, size_t buf_len) {
+    return io_backend::read_file(filename, reinterpret_cast<char*>(sealed_buf), buf_len);
 }
 
 int ocall_write_sealed_file(const char* filename, const uint8_t* sealed_data, size_t data_len) {
+    io_backend::forget(filename);
     FILE* file = fopen(filename, "wb");
     if (!file) return -1;
 
@@ -47,3 +93,49 @@ int ocall_write_sealed_file(const char* filename, const uint8_t* sealed_data, si
     fclose(file);
     return (written == data_len) ? 0 : -1;
 }
+
+int ocall_stream_open_read(const char* filename, uint8_t* header, size_t header_len,
+                           uint64_t* file_size) {
+    return stream_io::open_read(filename, header, header_len, file_size);
+}
+
+size_t ocall_stream_read(int handle, uint8_t* buf, size_t buf_len) {
+    return stream_io::read(handle, buf, buf_len);
+}
+
+int ocall_stream_open_write(const char* filename) {
+    io_backend::forget(filename);
+    return stream_io::open_write(filename);
+}
+
+int ocall_stream_write(int handle, const uint8_t* buf, size_t len) {
+    return stream_io::write(handle, buf, len);
+}
+
+int ocall_stream_close(int handle) {
+    return stream_io::close(handle);
+}
+
+void ocall_marshal_in(const uint8_t* buf, size_t len) {
+    (void)buf;
+    (void)len;
+}
+
+void ocall_marshal_out(uint8_t* buf, size_t len) {
+    (void)buf;
+    (void)len;
+}
+
+void ocall_marshal_inout(uint8_t* buf, size_t len) {
+    (void)buf;
+    (void)len;
+}
+
+void ocall_marshal_user_check(uint8_t* buf, size_t len) {
+    (void)buf;
+    (void)len;
+}
+
+void ocall_trace_export(const trace_event_t* events, size_t count) {
+    trace_report::append(events, count);
+}
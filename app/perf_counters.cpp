@@ -0,0 +1,154 @@
+// app/perf_counters.cpp
+#include "perf_counters.h"
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <ostream>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+static uint64_t cache_config(uint64_t cache, uint64_t op, uint64_t result) {
+    return cache | (op << 8) | (result << 16);
+}
+
+static void describe_event(int event, perf_event_attr& attr) {
+    switch (event) {
+        case PERF_INSTRUCTIONS:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+            break;
+        case PERF_LLC_MISSES:
+            attr.type = PERF_TYPE_HW_CACHE;
+            attr.config = cache_config(PERF_COUNT_HW_CACHE_LL, PERF_COUNT_HW_CACHE_OP_READ,
+                                       PERF_COUNT_HW_CACHE_RESULT_MISS);
+            break;
+        case PERF_L1D_MISSES:
+            attr.type = PERF_TYPE_HW_CACHE;
+            attr.config = cache_config(PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_OP_READ,
+                                       PERF_COUNT_HW_CACHE_RESULT_MISS);
+            break;
+        case PERF_DTLB_MISSES:
+            attr.type = PERF_TYPE_HW_CACHE;
+            attr.config = cache_config(PERF_COUNT_HW_CACHE_DTLB, PERF_COUNT_HW_CACHE_OP_READ,
+                                       PERF_COUNT_HW_CACHE_RESULT_MISS);
+            break;
+        case PERF_BRANCH_MISSES:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+            break;
+    }
+}
+
+const char* PerfCounterGroup::event_name(int event) {
+    switch (event) {
+        case PERF_INSTRUCTIONS: return "instructions";
+        case PERF_LLC_MISSES: return "llc_misses";
+        case PERF_L1D_MISSES: return "l1d_misses";
+        case PERF_DTLB_MISSES: return "dtlb_misses";
+        case PERF_BRANCH_MISSES: return "branch_misses";
+    }
+    return "unknown";
+}
+
+PerfCounterGroup::PerfCounterGroup() : opened(0) {
+    for (int i = 0; i < PERF_EVENT_COUNT; i++) {
+        fds[i] = -1;
+        slot_event[i] = -1;
+    }
+}
+
+PerfCounterGroup::~PerfCounterGroup() {
+    close();
+}
+
+bool PerfCounterGroup::open() {
+    close();
+
+    int leader = -1;
+    for (int event = 0; event < PERF_EVENT_COUNT; event++) {
+        perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        describe_event(event, attr);
+        attr.disabled = (leader == -1) ? 1 : 0;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED |
+                           PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        int fd = static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, leader, 0));
+        if (fd < 0) {
+            std::cerr << "perf: " << event_name(event) << " unavailable ("
+                      << strerror(errno) << ")" << std::endl;
+            continue;
+        }
+        if (leader == -1) leader = fd;
+        fds[event] = fd;
+        slot_event[opened++] = event;
+    }
+
+    if (!available()) {
+        std::cerr << "perf: no hardware counters available, continuing without them" << std::endl;
+    }
+    return available();
+}
+
+void PerfCounterGroup::close() {
+    for (int i = 0; i < PERF_EVENT_COUNT; i++) {
+        if (fds[i] >= 0) ::close(fds[i]);
+        fds[i] = -1;
+        slot_event[i] = -1;
+    }
+    opened = 0;
+}
+
+void PerfCounterGroup::enable() {
+    if (!available()) return;
+    int leader = fds[slot_event[0]];
+    ioctl(leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+}
+
+void PerfCounterGroup::resume() {
+    if (!available()) return;
+    ioctl(fds[slot_event[0]], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+}
+
+void PerfCounterGroup::disable() {
+    if (!available()) return;
+    ioctl(fds[slot_event[0]], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+}
+
+PerfCounts PerfCounterGroup::read(uint64_t operations) const {
+    PerfCounts counts;
+    memset(&counts, 0, sizeof(counts));
+    if (!available() || operations == 0) return counts;
+
+    // Layout for PERF_FORMAT_GROUP: nr, time_enabled, time_running, value[nr]
+    uint64_t data[3 + PERF_EVENT_COUNT];
+    ssize_t expected = static_cast<ssize_t>((3 + opened) * sizeof(uint64_t));
+    if (::read(fds[slot_event[0]], data, sizeof(data)) < expected) return counts;
+
+    uint64_t enabled = data[1];
+    uint64_t running = data[2];
+    if (running == 0) return counts;
+    double scale = static_cast<double>(enabled) / static_cast<double>(running);
+
+    for (int slot = 0; slot < opened; slot++) {
+        int event = slot_event[slot];
+        counts.supported[event] = true;
+        counts.per_op[event] = static_cast<double>(data[3 + slot]) * scale /
+                               static_cast<double>(operations);
+    }
+    counts.valid = true;
+    return counts;
+}
+
+void write_perf_columns(std::ostream& out, const PerfCounts& counts) {
+    for (int event = 0; event < PERF_EVENT_COUNT; event++) {
+        out << ",";
+        if (counts.valid && counts.supported[event]) out << counts.per_op[event];
+    }
+}
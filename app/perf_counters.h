@@ -0,0 +1,59 @@
+// app/perf_counters.h
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <cstdint>
+#include <iosfwd>
+
+enum PerfEvent {
+    PERF_INSTRUCTIONS = 0,
+    PERF_LLC_MISSES,
+    PERF_L1D_MISSES,
+    PERF_DTLB_MISSES,
+    PERF_BRANCH_MISSES,
+    PERF_EVENT_COUNT
+};
+
+struct PerfCounts {
+    bool valid;
+    bool supported[PERF_EVENT_COUNT];
+    double per_op[PERF_EVENT_COUNT];
+};
+
+// Group of perf_event_open counters for the calling thread, read in one
+// shot and scaled for multiplexing. Events the PMU or kernel refuses are
+// skipped individually; if none can be opened the group is unavailable
+// and every read returns an invalid PerfCounts.
+//
+// Note that production (non-debug) enclaves suppress counting while the
+// CPU is in enclave mode, so in-enclave events only show up for debug
+// enclaves or in simulation mode.
+class PerfCounterGroup {
+private:
+    int fds[PERF_EVENT_COUNT];
+    int slot_event[PERF_EVENT_COUNT];   // read-format slot -> PerfEvent
+    int opened;
+
+public:
+    PerfCounterGroup();
+    ~PerfCounterGroup();
+    PerfCounterGroup(const PerfCounterGroup&) = delete;
+    PerfCounterGroup& operator=(const PerfCounterGroup&) = delete;
+
+    bool open();
+    void close();
+    bool available() const { return opened > 0; }
+
+    void enable();
+    // Enables without the reset, to count across several enable/disable windows
+    void resume();
+    void disable();
+    PerfCounts read(uint64_t operations) const;
+
+    static const char* event_name(int event);
+};
+
+// Appends one ",value" CSV column per event; unsupported events are left empty
+void write_perf_columns(std::ostream& out, const PerfCounts& counts);
+
+#endif // PERF_COUNTERS_H
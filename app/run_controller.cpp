@@ -0,0 +1,135 @@
+// app/run_controller.cpp
+#include "run_controller.h"
+#include "config_parser.h"
+#include "cycle_counter.h"
+#include "enclave_u.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+
+extern sgx_enclave_id_t global_eid;
+
+static double mean_of(const std::vector<double>& values) {
+    if (values.empty()) return 0.0;
+    double sum = 0.0;
+    for (double v : values) sum += v;
+    return sum / static_cast<double>(values.size());
+}
+
+static double median_of(std::vector<double> values) {
+    if (values.empty()) return 0.0;
+    std::sort(values.begin(), values.end());
+    size_t mid = values.size() / 2;
+    if (values.size() % 2 == 0) return (values[mid - 1] + values[mid]) / 2.0;
+    return values[mid];
+}
+
+std::vector<double> reject_outliers(const std::vector<double>& samples) {
+    if (samples.size() < 3) return samples;
+
+    double median = median_of(samples);
+    std::vector<double> deviations;
+    for (double v : samples) deviations.push_back(std::fabs(v - median));
+    double mad = median_of(deviations);
+    if (mad <= 0.0) return samples;
+
+    std::vector<double> kept;
+    for (double v : samples) {
+        double modified_z = 0.6745 * (v - median) / mad;
+        if (std::fabs(modified_z) <= 3.5) kept.push_back(v);
+    }
+    return kept;
+}
+
+OverheadEstimate bootstrap_overhead(const std::vector<double>& baseline,
+                                    const std::vector<double>& candidate,
+                                    int resamples, double confidence, uint32_t seed) {
+    OverheadEstimate estimate = {0.0, 0.0, 0.0, false};
+    double base_mean = mean_of(baseline);
+    if (baseline.empty() || candidate.empty() || base_mean <= 0.0) return estimate;
+
+    estimate.overhead_pct = (mean_of(candidate) / base_mean - 1.0) * 100.0;
+
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<size_t> pick_base(0, baseline.size() - 1);
+    std::uniform_int_distribution<size_t> pick_cand(0, candidate.size() - 1);
+
+    std::vector<double> ratios;
+    ratios.reserve(static_cast<size_t>(resamples));
+    for (int r = 0; r < resamples; r++) {
+        double base_sum = 0.0, cand_sum = 0.0;
+        for (size_t i = 0; i < baseline.size(); i++) base_sum += baseline[pick_base(rng)];
+        for (size_t i = 0; i < candidate.size(); i++) cand_sum += candidate[pick_cand(rng)];
+        double base = base_sum / static_cast<double>(baseline.size());
+        double cand = cand_sum / static_cast<double>(candidate.size());
+        ratios.push_back((cand / base - 1.0) * 100.0);
+    }
+    std::sort(ratios.begin(), ratios.end());
+
+    double tail = (1.0 - confidence) / 2.0;
+    size_t last = ratios.size() - 1;
+    estimate.ci_low_pct = ratios[static_cast<size_t>(tail * static_cast<double>(last))];
+    estimate.ci_high_pct = ratios[static_cast<size_t>((1.0 - tail) * static_cast<double>(last))];
+    estimate.significant = (estimate.ci_low_pct > 0.0) || (estimate.ci_high_pct < 0.0);
+    return estimate;
+}
+
+int RunController::warm_up_until_steady(int block_size, int window,
+                                        double cv_threshold, int max_blocks) {
+    std::vector<double> block_means;
+    int calls = 0;
+
+    for (int block = 0; block < max_blocks; block++) {
+        uint64_t start = CycleCounter::start();
+        for (int i = 0; i < block_size; i++) {
+            ecall_warmup(global_eid);
+        }
+        uint64_t elapsed = CycleCounter::elapsed_since(start);
+        calls += block_size;
+        block_means.push_back(static_cast<double>(elapsed) / block_size);
+
+        if (block_means.size() < static_cast<size_t>(window)) continue;
+
+        std::vector<double> recent(block_means.end() - window, block_means.end());
+        double mean = mean_of(recent);
+        double var = 0.0;
+        for (double v : recent) var += (v - mean) * (v - mean);
+        double cv = std::sqrt(var / static_cast<double>(window)) / mean;
+        if (cv < cv_threshold) return calls;
+    }
+
+    std::cerr << "Warm-up did not reach steady state after " << calls << " calls" << std::endl;
+    return calls;
+}
+
+void RunController::apply_mitigations(const std::string& mitigations) {
+    parse_mitigations(mitigations);
+    runner.setup_environment();
+}
+
+bool RunController::compare(const std::string& test_type, const std::string& filename,
+                            int iterations, const std::string& baseline_set,
+                            const std::string& candidate_set,
+                            RepeatedResult& baseline, RepeatedResult& candidate) {
+    baseline.samples.clear();
+    candidate.samples.clear();
+
+    for (int rep = 0; rep < repetitions; rep++) {
+        BenchmarkResult result = {0.0, 0, 0.0, LatencyStats()};
+
+        apply_mitigations(baseline_set);
+        if (!runner.run_test(test_type, filename, iterations, result)) return false;
+        baseline.samples.push_back(result.cycles_per_op);
+
+        apply_mitigations(candidate_set);
+        if (!runner.run_test(test_type, filename, iterations, result)) return false;
+        candidate.samples.push_back(result.cycles_per_op);
+    }
+
+    baseline.kept = reject_outliers(baseline.samples);
+    baseline.mean = mean_of(baseline.kept);
+    candidate.kept = reject_outliers(candidate.samples);
+    candidate.mean = mean_of(candidate.kept);
+    return true;
+}
@@ -0,0 +1,58 @@
+// app/run_controller.h
+#ifndef RUN_CONTROLLER_H
+#define RUN_CONTROLLER_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "benchmark_runner.h"
+
+struct RepeatedResult {
+    std::vector<double> samples;    // cycles per op, one per repetition
+    std::vector<double> kept;       // samples that survived outlier rejection
+    double mean;
+};
+
+struct OverheadEstimate {
+    double overhead_pct;
+    double ci_low_pct;
+    double ci_high_pct;
+    bool significant;               // confidence interval excludes zero
+};
+
+// Median-absolute-deviation filter: drops samples whose modified z-score
+// exceeds 3.5. Inputs with fewer than three samples are returned unchanged.
+std::vector<double> reject_outliers(const std::vector<double>& samples);
+
+// Percentile bootstrap of mean(candidate) / mean(baseline) - 1, with both
+// groups resampled independently. The interval is two-sided at `confidence`.
+OverheadEstimate bootstrap_overhead(const std::vector<double>& baseline,
+                                    const std::vector<double>& candidate,
+                                    int resamples = 10000, double confidence = 0.95,
+                                    uint32_t seed = 1);
+
+class RunController {
+private:
+    BenchmarkRunner& runner;
+    int repetitions;
+
+    void apply_mitigations(const std::string& mitigations);
+
+public:
+    RunController(BenchmarkRunner& bench_runner, int reps)
+        : runner(bench_runner), repetitions(reps) {}
+
+    // Runs ecall_warmup in fixed-size blocks until the coefficient of
+    // variation of the last `window` block means drops below cv_threshold,
+    // or max_blocks is reached. Returns the number of warm-up calls made.
+    static int warm_up_until_steady(int block_size = 50, int window = 5,
+                                    double cv_threshold = 0.02, int max_blocks = 400);
+
+    // Alternates baseline and candidate repetitions so that slow drift
+    // affects both groups equally, then rejects outliers in each.
+    bool compare(const std::string& test_type, const std::string& filename, int iterations,
+                 const std::string& baseline_set, const std::string& candidate_set,
+                 RepeatedResult& baseline, RepeatedResult& candidate);
+};
+
+#endif // RUN_CONTROLLER_H
@@ -0,0 +1,59 @@
+// app/sealed_stream_format.h - On-disk layout of chunked sealed files
+#ifndef SEALED_STREAM_FORMAT_H
+#define SEALED_STREAM_FORMAT_H
+
+#include <stdint.h>
+
+#define SEALED_STREAM_MAGIC 0x31534653u     // "SFS1"
+#define SEALED_STREAM_VERSION 1
+
+#define SEALED_STREAM_DEFAULT_CHUNK (64 * 1024)
+#define SEALED_STREAM_MIN_CHUNK 4096
+// Records travel through [out]/[in] OCALL buffers, which edger8r places on
+// the untrusted stack, so a record must stay well below its 8 MB limit
+#define SEALED_STREAM_MAX_CHUNK (1024 * 1024)
+
+#define SEALED_STREAM_KEY_SIZE 16
+#define SEALED_STREAM_MAC_SIZE 16
+#define SEALED_STREAM_IV_SIZE 12
+// Room for the sgx_seal_data() blob that wraps the file key
+#define SEALED_STREAM_KEY_BLOB_SIZE 640
+
+#define SEALED_STREAM_OK 0
+#define SEALED_STREAM_BAD_ARG 1
+#define SEALED_STREAM_IO_ERROR 2
+#define SEALED_STREAM_BAD_HEADER 3
+#define SEALED_STREAM_AUTH_FAILED 4
+#define SEALED_STREAM_CRYPTO_ERROR 5
+
+// A sealed stream is this header followed by chunk_count records of
+// [MAC | ciphertext]; every record but the last holds chunk_size bytes.
+//
+// Each file has a random AES-128-GCM key, sealed to the enclave in
+// key_blob. The header fields in front of key_blob are the blob's
+// additional MAC text, so editing any of them makes the key unseal fail.
+// Chunk i is encrypted with IV = i and authenticated together with a
+// sealed_stream_chunk_aad_t, which stops chunks from being reordered,
+// dropped or spliced in from another file.
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t chunk_size;
+    uint32_t key_blob_size;
+    uint64_t chunk_count;
+    uint64_t plain_size;
+    uint8_t file_id[16];
+    uint8_t key_blob[SEALED_STREAM_KEY_BLOB_SIZE];
+} sealed_stream_header_t;
+
+#define SEALED_STREAM_HEADER_MAC_TEXT_SIZE \
+    (sizeof(sealed_stream_header_t) - SEALED_STREAM_KEY_BLOB_SIZE)
+
+typedef struct {
+    uint8_t file_id[16];
+    uint64_t index;
+    uint32_t length;
+    uint32_t final_chunk;
+} sealed_stream_chunk_aad_t;
+
+#endif // SEALED_STREAM_FORMAT_H
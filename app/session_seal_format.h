@@ -0,0 +1,48 @@
+// app/session_seal_format.h - Files sealed under the cached session key
+#ifndef SESSION_SEAL_FORMAT_H
+#define SESSION_SEAL_FORMAT_H
+
+#include <stdint.h>
+
+#define SESSION_SEAL_MAGIC 0x4b535331u      // "1SSK"
+#define SESSION_SEAL_VERSION 1
+
+// Same plaintext limit as ecall_create_sealed_file
+#define SESSION_SEAL_MAX_PAYLOAD 4096
+#define SESSION_SEAL_IV_SIZE 12
+#define SESSION_SEAL_MAC_SIZE 16
+// sizeof(sgx_key_request_t), kept here so the app side needs no SGX types
+#define SESSION_SEAL_KEY_REQUEST_SIZE 512
+
+// How ecall_session_unseal_file obtains the key
+#define SESSION_UNSEAL_CACHED 0     // session key held in enclave memory
+#define SESSION_UNSEAL_DERIVE 1     // EGETKEY from the stored key request
+
+#define SESSION_SEAL_OK 0
+#define SESSION_SEAL_BAD_ARG 1
+#define SESSION_SEAL_IO_ERROR 2
+#define SESSION_SEAL_BAD_HEADER 3
+#define SESSION_SEAL_AUTH_FAILED 4
+#define SESSION_SEAL_CRYPTO_ERROR 5
+// File was sealed under an earlier session key; reseal or use DERIVE
+#define SESSION_SEAL_STALE_KEY 6
+
+// A session-sealed file is this header followed by payload_size bytes of
+// AES-128-GCM ciphertext. The key is an EGETKEY seal key derived once per
+// session (and on every rotation) from key_request, which is stored so a
+// later session can derive the same key again. Each file has a random IV,
+// and every header field in front of iv is authenticated as AAD.
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t generation;
+    uint32_t payload_size;
+    uint8_t key_request[SESSION_SEAL_KEY_REQUEST_SIZE];
+    uint8_t iv[SESSION_SEAL_IV_SIZE];
+    uint8_t mac[SESSION_SEAL_MAC_SIZE];
+} session_sealed_header_t;
+
+#define SESSION_SEAL_AAD_SIZE \
+    (sizeof(session_sealed_header_t) - SESSION_SEAL_IV_SIZE - SESSION_SEAL_MAC_SIZE)
+
+#endif // SESSION_SEAL_FORMAT_H
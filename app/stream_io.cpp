@@ -0,0 +1,201 @@
+// app/stream_io.cpp
+#include "stream_io.h"
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Runs one queued job at a time on a dedicated thread
+class IoWorker {
+public:
+    IoWorker() : busy_(false), stopping_(false), thread_(&IoWorker::loop, this) {}
+
+    ~IoWorker() {
+        wait();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        cv_.notify_all();
+        thread_.join();
+    }
+
+    void submit(std::function<void()> job) {
+        wait();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            job_ = std::move(job);
+            busy_ = true;
+        }
+        cv_.notify_all();
+    }
+
+    void wait() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this] { return !busy_; });
+    }
+
+private:
+    void loop() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        for (;;) {
+            cv_.wait(lock, [this] { return busy_ || stopping_; });
+            if (!busy_) return;
+
+            std::function<void()> job = std::move(job_);
+            lock.unlock();
+            job();
+            lock.lock();
+            busy_ = false;
+            cv_.notify_all();
+        }
+    }
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::function<void()> job_;
+    bool busy_;
+    bool stopping_;
+    std::thread thread_;    // declared last so it starts after the state above
+};
+
+struct Stream {
+    FILE* file = nullptr;
+    bool writing = false;
+    // Set by the worker; only read after IoWorker::wait()
+    bool failed = false;
+    size_t record_len = 0;
+    size_t back_len = 0;
+    std::vector<uint8_t> front;
+    std::vector<uint8_t> back;
+    IoWorker worker;
+};
+
+std::mutex g_streams_mutex;
+std::map<int, std::unique_ptr<Stream>> g_streams;
+int g_next_handle = 1;
+
+int register_stream(std::unique_ptr<Stream> stream) {
+    std::lock_guard<std::mutex> lock(g_streams_mutex);
+    int handle = g_next_handle++;
+    g_streams[handle] = std::move(stream);
+    return handle;
+}
+
+Stream* find_stream(int handle) {
+    std::lock_guard<std::mutex> lock(g_streams_mutex);
+    auto it = g_streams.find(handle);
+    return it == g_streams.end() ? nullptr : it->second.get();
+}
+
+void queue_prefetch(Stream* stream) {
+    stream->worker.submit([stream] {
+        stream->back_len = fread(stream->back.data(), 1, stream->record_len, stream->file);
+    });
+}
+
+} // namespace
+
+namespace stream_io {
+
+int open_read(const char* filename, uint8_t* header, size_t header_len, uint64_t* file_size) {
+    *file_size = 0;
+    FILE* file = fopen(filename, "rb");
+    if (!file) return -1;
+
+    if (fseeko(file, 0, SEEK_END) != 0) {
+        fclose(file);
+        return -1;
+    }
+    *file_size = static_cast<uint64_t>(ftello(file));
+    rewind(file);
+
+    if (header_len > 0 && fread(header, 1, header_len, file) != header_len) {
+        fclose(file);
+        return -1;
+    }
+
+    std::unique_ptr<Stream> stream(new Stream());
+    stream->file = file;
+    return register_stream(std::move(stream));
+}
+
+size_t read(int handle, uint8_t* buf, size_t buf_len) {
+    Stream* stream = find_stream(handle);
+    if (!stream || stream->writing || buf_len == 0) return 0;
+
+    if (stream->record_len == 0) {
+        stream->record_len = buf_len;
+        stream->front.resize(buf_len);
+        stream->back.resize(buf_len);
+        stream->back_len = fread(stream->back.data(), 1, buf_len, stream->file);
+    } else if (buf_len != stream->record_len) {
+        return 0;
+    }
+
+    stream->worker.wait();
+    std::swap(stream->front, stream->back);
+    size_t bytes = stream->back_len;
+    stream->back_len = 0;
+
+    // A short record means end of file; otherwise start on the next one
+    // before copying this one out
+    if (bytes == stream->record_len) {
+        queue_prefetch(stream);
+    }
+    memcpy(buf, stream->front.data(), bytes);
+    return bytes;
+}
+
+int open_write(const char* filename) {
+    FILE* file = fopen(filename, "wb");
+    if (!file) return -1;
+
+    std::unique_ptr<Stream> stream(new Stream());
+    stream->file = file;
+    stream->writing = true;
+    return register_stream(std::move(stream));
+}
+
+int write(int handle, const uint8_t* buf, size_t len) {
+    Stream* stream = find_stream(handle);
+    if (!stream || !stream->writing) return -1;
+
+    // The worker only touches `back`, so the copy overlaps the previous write
+    stream->front.assign(buf, buf + len);
+    stream->worker.wait();
+    if (stream->failed) return -1;
+
+    std::swap(stream->front, stream->back);
+    stream->worker.submit([stream] {
+        if (fwrite(stream->back.data(), 1, stream->back.size(), stream->file) != stream->back.size()) {
+            stream->failed = true;
+        }
+    });
+    return 0;
+}
+
+int close(int handle) {
+    std::unique_ptr<Stream> stream;
+    {
+        std::lock_guard<std::mutex> lock(g_streams_mutex);
+        auto it = g_streams.find(handle);
+        if (it == g_streams.end()) return -1;
+        stream = std::move(it->second);
+        g_streams.erase(it);
+    }
+
+    stream->worker.wait();
+    bool ok = !stream->failed;
+    if (fclose(stream->file) != 0) ok = false;
+    return ok ? 0 : -1;
+}
+
+} // namespace stream_io
@@ -0,0 +1,25 @@
+// app/stream_io.h - Double-buffered file streams behind the ocall_stream_* handlers
+#ifndef STREAM_IO_H
+#define STREAM_IO_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Handle-based streams for the chunked sealed-file OCALLs. Each stream owns
+// a worker thread and two buffers:
+//  - read streams return fixed-size records. The first read fixes the
+//    record length and is served synchronously; after that every read
+//    hands back the record prefetched by the previous call and queues the
+//    next one, so disk I/O overlaps the enclave's decryption.
+//  - write streams copy the record and queue the write, so the enclave can
+//    seal the next chunk while the previous one reaches the file.
+// close() waits for queued work and reports any write failure.
+namespace stream_io {
+    int open_read(const char* filename, uint8_t* header, size_t header_len, uint64_t* file_size);
+    size_t read(int handle, uint8_t* buf, size_t buf_len);
+    int open_write(const char* filename);
+    int write(int handle, const uint8_t* buf, size_t len);
+    int close(int handle);
+}
+
+#endif // STREAM_IO_H
@@ -0,0 +1,210 @@
+// app/sweep_runner.cpp
+#include "sweep_runner.h"
+#include "config_parser.h"
+#include "run_controller.h"
+#include "cycle_counter.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <random>
+#include <tuple>
+
+static std::string trim(const std::string& str) {
+    size_t begin = str.find_first_not_of(" \t\r\n");
+    if (begin == std::string::npos) return "";
+    size_t end = str.find_last_not_of(" \t\r\n");
+    return str.substr(begin, end - begin + 1);
+}
+
+static std::vector<std::string> split(const std::string& str, char delimiter) {
+    std::vector<std::string> parts;
+    std::string remaining = str + delimiter;
+    size_t pos = 0;
+    while ((pos = remaining.find(delimiter)) != std::string::npos) {
+        std::string part = trim(remaining.substr(0, pos));
+        if (!part.empty()) parts.push_back(part);
+        remaining.erase(0, pos + 1);
+    }
+    return parts;
+}
+
+bool load_sweep_matrix(const std::string& path, SweepMatrix& matrix) {
+    std::ifstream in(path);
+    if (!in) {
+        std::cerr << "Cannot open matrix file: " << path << "\n";
+        return false;
+    }
+
+    matrix.tests.clear();
+    matrix.mitigation_sets.clear();
+    matrix.iterations.clear();
+    matrix.repetitions = 1;
+    matrix.seed = std::random_device()();
+    matrix.filename = "test.txt";
+
+    std::string line;
+    int line_no = 0;
+    while (std::getline(in, line)) {
+        line_no++;
+        line = trim(line.substr(0, line.find('#')));
+        if (line.empty()) continue;
+
+        size_t eq = line.find('=');
+        if (eq == std::string::npos) {
+            std::cerr << path << ":" << line_no << ": expected key = value\n";
+            return false;
+        }
+        std::string key = trim(line.substr(0, eq));
+        std::string value = trim(line.substr(eq + 1));
+
+        if (key == "tests") {
+            matrix.tests = split(value, ',');
+        } else if (key == "mitigations") {
+            matrix.mitigation_sets = split(value, ';');
+        } else if (key == "iterations") {
+            for (long long n : parse_size_list(value)) {
+                if (n > 0) matrix.iterations.push_back(static_cast<int>(n));
+            }
+        } else if (key == "repetitions") {
+            matrix.repetitions = std::stoi(value);
+        } else if (key == "seed") {
+            matrix.seed = static_cast<uint32_t>(std::stoul(value));
+        } else if (key == "file") {
+            matrix.filename = value;
+        } else {
+            std::cerr << path << ":" << line_no << ": unknown key '" << key << "'\n";
+            return false;
+        }
+    }
+
+    if (matrix.tests.empty() || matrix.mitigation_sets.empty() ||
+        matrix.iterations.empty() || matrix.repetitions < 1) {
+        std::cerr << path << ": tests, mitigations and iterations are required\n";
+        return false;
+    }
+    return true;
+}
+
+// Overhead of every mitigation set against 'none' for each test and
+// iteration count, using the repetitions of each cell as samples.
+static void write_sweep_summary(
+        const SweepMatrix& matrix,
+        const std::map<std::tuple<std::string, std::string, int>, std::vector<double>>& samples,
+        const std::string& summary_file) {
+    if (std::find(matrix.mitigation_sets.begin(), matrix.mitigation_sets.end(), "none") ==
+        matrix.mitigation_sets.end()) {
+        std::cerr << "No 'none' mitigation set in matrix, skipping overhead summary\n";
+        return;
+    }
+
+    std::ofstream csv(summary_file, std::ios::trunc);
+    csv << "test_type,mitigations,iterations,repetitions_kept,baseline_cycles_per_op,"
+        << "cycles_per_op,overhead_pct,ci_low_pct,ci_high_pct,significant\n";
+
+    for (const std::string& test : matrix.tests) {
+        for (int iterations : matrix.iterations) {
+            auto base_it = samples.find(std::make_tuple(test, std::string("none"), iterations));
+            if (base_it == samples.end()) continue;
+            std::vector<double> baseline = reject_outliers(base_it->second);
+
+            for (const std::string& set : matrix.mitigation_sets) {
+                if (set == "none") continue;
+                auto it = samples.find(std::make_tuple(test, set, iterations));
+                if (it == samples.end()) continue;
+                std::vector<double> candidate = reject_outliers(it->second);
+
+                double base_mean = 0.0, cand_mean = 0.0;
+                for (double v : baseline) base_mean += v;
+                for (double v : candidate) cand_mean += v;
+                base_mean /= static_cast<double>(baseline.size());
+                cand_mean /= static_cast<double>(candidate.size());
+
+                OverheadEstimate estimate = bootstrap_overhead(baseline, candidate);
+                csv << test << ",\"" << set << "\"," << iterations << ","
+                    << candidate.size() << "," << base_mean << "," << cand_mean << ","
+                    << estimate.overhead_pct << "," << estimate.ci_low_pct << ","
+                    << estimate.ci_high_pct << "," << (estimate.significant ? 1 : 0) << "\n";
+            }
+        }
+    }
+    std::cout << "Overhead summary written to " << summary_file << std::endl;
+}
+
+int run_sweep(BenchmarkRunner& runner, const SweepMatrix& matrix, const std::string& allocator,
+              const std::string& output_file) {
+    std::vector<SweepCell> cells;
+    for (int rep = 0; rep < matrix.repetitions; rep++) {
+        for (const std::string& test : matrix.tests) {
+            for (const std::string& set : matrix.mitigation_sets) {
+                for (int iterations : matrix.iterations) {
+                    cells.push_back({test, set, iterations, rep});
+                }
+            }
+        }
+    }
+
+    std::mt19937 rng(matrix.seed);
+    std::shuffle(cells.begin(), cells.end(), rng);
+
+    if (std::find(matrix.tests.begin(), matrix.tests.end(), "sealed_file") != matrix.tests.end()) {
+        runner.create_sealed_test_file(matrix.filename);
+    }
+
+    std::ofstream csv(output_file, std::ios::trunc);
+    if (!csv) {
+        std::cerr << "Cannot open output file: " << output_file << "\n";
+        return 1;
+    }
+    csv << "order,test_type,mitigations,repetition,iterations,total_time_ms,time_per_op_us,"
+        << "total_cycles,cycles_per_op,min_cycles,p50_cycles,p90_cycles,p99_cycles,"
+        << "p999_cycles,max_cycles,stddev_cycles,seed,allocator,cache_state,ns_per_op";
+    for (int event = 0; event < PERF_EVENT_COUNT; event++) {
+        csv << "," << PerfCounterGroup::event_name(event) << "_per_op";
+    }
+    csv << "\n";
+
+    // (test, mitigation set, iterations) -> cycles_per_op of each repetition
+    std::map<std::tuple<std::string, std::string, int>, std::vector<double>> samples;
+
+    int failures = 0;
+    for (size_t order = 0; order < cells.size(); order++) {
+        const SweepCell& cell = cells[order];
+        parse_mitigations(cell.mitigations);
+        runner.setup_environment();
+
+        std::cout << "[" << order + 1 << "/" << cells.size() << "] " << cell.test_type
+                  << " / " << cell.mitigations << " / " << cell.iterations
+                  << " (rep " << cell.repetition << ")" << std::endl;
+
+        BenchmarkResult result = {0.0, 0, 0.0, LatencyStats()};
+        if (!runner.run_test(cell.test_type, matrix.filename, cell.iterations, result)) {
+            std::cerr << "Unknown test type: " << cell.test_type << "\n";
+            failures++;
+            continue;
+        }
+
+        double time_per_op = (result.time_ms * 1000.0) / cell.iterations;
+        // Mitigation sets contain commas, so they are quoted
+        csv << order << "," << cell.test_type << ",\"" << cell.mitigations << "\","
+            << cell.repetition << "," << cell.iterations << ","
+            << result.time_ms << "," << time_per_op << ","
+            << result.cycles << "," << result.cycles_per_op << ","
+            << result.latency.min_cycles << "," << result.latency.p50_cycles << ","
+            << result.latency.p90_cycles << "," << result.latency.p99_cycles << ","
+            << result.latency.p999_cycles << "," << result.latency.max_cycles << ","
+            << result.latency.stddev_cycles << "," << matrix.seed << "," << allocator << ","
+            << runner.cache_conditioner().name() << ","
+            << CycleCounter::cycles_to_ns(result.cycles_per_op);
+        write_perf_columns(csv, result.perf);
+        csv << "\n";
+        csv.flush();
+        samples[std::make_tuple(cell.test_type, cell.mitigations, cell.iterations)]
+            .push_back(result.cycles_per_op);
+    }
+
+    if (matrix.repetitions > 1) {
+        write_sweep_summary(matrix, samples, output_file + ".summary.csv");
+    }
+    return failures == 0 ? 0 : 1;
+}
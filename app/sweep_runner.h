@@ -0,0 +1,44 @@
+// app/sweep_runner.h
+#ifndef SWEEP_RUNNER_H
+#define SWEEP_RUNNER_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "benchmark_runner.h"
+
+// Test x mitigation matrix loaded from a key = value file:
+//   tests       = ecall, pingpong, sealed_file
+//   mitigations = none; lfence; cache,constant; all
+//   iterations  = 100000
+//   repetitions = 5
+//   seed        = 42          (optional, random if omitted)
+//   file        = test.txt    (optional)
+// Mitigation sets are separated by ';' since a set is itself a comma list.
+struct SweepMatrix {
+    std::vector<std::string> tests;
+    std::vector<std::string> mitigation_sets;
+    std::vector<int> iterations;
+    int repetitions;
+    uint32_t seed;
+    std::string filename;
+};
+
+struct SweepCell {
+    std::string test_type;
+    std::string mitigations;
+    int iterations;
+    int repetition;
+};
+
+bool load_sweep_matrix(const std::string& path, SweepMatrix& matrix);
+
+// Runs every cell of the matrix in a seeded random order against the
+// already-initialized enclave, switching mitigation sets in place, and
+// streams one CSV row per cell to output_file. allocator names the per-call
+// buffer allocator the enclave was set to; it is recorded on every row
+// along with the runner's cache state.
+int run_sweep(BenchmarkRunner& runner, const SweepMatrix& matrix, const std::string& allocator,
+              const std::string& output_file);
+
+#endif // SWEEP_RUNNER_H
@@ -0,0 +1,142 @@
+// app/trace_report.cpp
+#include "trace_report.h"
+#include <fstream>
+#include <map>
+#include <mutex>
+
+namespace {
+
+std::mutex g_trace_mutex;
+std::vector<trace_event_t> g_trace_events;
+
+struct OpenSpan {
+    int phase;
+    uint64_t begin;
+    uint64_t nested_cycles;
+};
+
+} // namespace
+
+namespace trace_report {
+
+void clear() {
+    std::lock_guard<std::mutex> lock(g_trace_mutex);
+    g_trace_events.clear();
+}
+
+void append(const trace_event_t* events, size_t count) {
+    std::lock_guard<std::mutex> lock(g_trace_mutex);
+    g_trace_events.insert(g_trace_events.end(), events, events + count);
+}
+
+std::vector<trace_event_t> events() {
+    std::lock_guard<std::mutex> lock(g_trace_mutex);
+    return g_trace_events;
+}
+
+const char* phase_name(int phase) {
+    switch (phase) {
+        case TRACE_PHASE_OCALL: return "ocall";
+        case TRACE_PHASE_SEAL: return "seal";
+        case TRACE_PHASE_UNSEAL: return "unseal";
+        case TRACE_PHASE_CHECKSUM: return "checksum";
+        case TRACE_PHASE_ZERO: return "secure_memzero";
+        case TRACE_PHASE_FLUSH: return "cache_flush";
+        case TRACE_PHASE_COMPUTE: return "compute";
+        case TRACE_PHASE_KEY: return "seal_key";
+        case TRACE_PHASE_EXPORT: return "trace_export";
+        case TRACE_ECALL_EMPTY: return "ecall_empty";
+        case TRACE_ECALL_PING: return "ecall_ping";
+        case TRACE_ECALL_TRIGGER_OCALL: return "ecall_trigger_ocall";
+        case TRACE_ECALL_PURE_OCALL: return "ecall_measure_pure_ocall";
+        case TRACE_ECALL_FILE_READ: return "ecall_file_read";
+        case TRACE_ECALL_SGX_FILE_READ: return "ecall_sgx_file_read";
+        case TRACE_ECALL_CREATE_SEALED_FILE: return "ecall_create_sealed_file";
+        case TRACE_ECALL_CRYPTO: return "ecall_crypto_workload";
+        case TRACE_ECALL_ALLOC: return "ecall_alloc_workload";
+        case TRACE_ECALL_BATCH: return "ecall_batch";
+        case TRACE_ECALL_STREAM_SEAL: return "ecall_stream_seal_file";
+        case TRACE_ECALL_STREAM_UNSEAL: return "ecall_stream_unseal_file";
+        case TRACE_ECALL_FILE_READ_RING: return "ecall_file_read_ring";
+        case TRACE_ECALL_FILE_READ_MARSHALLED: return "ecall_file_read_marshalled";
+        case TRACE_ECALL_MARSHAL: return "ecall_marshal";
+        case TRACE_ECALL_MARSHAL_OCALL: return "ecall_measure_marshal_ocall";
+        case TRACE_ECALL_WORKING_SET_PREPARE: return "ecall_working_set_prepare";
+        case TRACE_ECALL_WORKING_SET_TOUCH: return "ecall_working_set_touch";
+        case TRACE_ECALL_SESSION_KEY_ROTATE: return "ecall_session_key_rotate";
+        case TRACE_ECALL_SESSION_SEAL: return "ecall_session_seal_file";
+        case TRACE_ECALL_SESSION_UNSEAL: return "ecall_session_unseal_file";
+        case TRACE_ECALL_CRYPTO_SUITE: return "ecall_crypto_suite_run";
+        case TRACE_ECALL_MEMOPS: return "ecall_memops_run";
+        case TRACE_ECALL_FLUSH_BENCH: return "ecall_flush_benchmark";
+        default: return "unknown";
+    }
+}
+
+std::vector<TracePhaseStats> breakdown(const std::vector<trace_event_t>& events,
+                                       uint64_t* unmatched) {
+    std::vector<TracePhaseStats> stats(TRACE_PHASE_COUNT);
+    for (int phase = 0; phase < TRACE_PHASE_COUNT; phase++) {
+        stats[phase] = {phase, 0, 0, 0};
+    }
+    *unmatched = 0;
+
+    std::map<uint32_t, std::vector<OpenSpan>> open;
+    for (const trace_event_t& event : events) {
+        std::vector<OpenSpan>& stack = open[event.ring];
+        if (event.kind == TRACE_BEGIN) {
+            stack.push_back({event.phase, event.tsc, 0});
+            continue;
+        }
+        if (stack.empty() || stack.back().phase != event.phase ||
+            event.phase >= TRACE_PHASE_COUNT || event.tsc < stack.back().begin) {
+            (*unmatched)++;
+            continue;
+        }
+        OpenSpan span = stack.back();
+        stack.pop_back();
+        uint64_t cycles = event.tsc - span.begin;
+        TracePhaseStats& phase = stats[span.phase];
+        phase.spans++;
+        phase.total_cycles += cycles;
+        phase.self_cycles += cycles > span.nested_cycles ? cycles - span.nested_cycles : 0;
+        if (!stack.empty()) stack.back().nested_cycles += cycles;
+    }
+    for (const auto& ring : open) *unmatched += ring.second.size();
+
+    std::vector<TracePhaseStats> used;
+    for (const TracePhaseStats& phase : stats) {
+        if (phase.spans > 0) used.push_back(phase);
+    }
+    return used;
+}
+
+bool write_chrome_trace(const std::string& path, const std::vector<trace_event_t>& events,
+                        double tsc_hz) {
+    std::ofstream json(path);
+    if (!json) return false;
+
+    uint64_t origin = UINT64_MAX;
+    for (const trace_event_t& event : events) {
+        if (event.tsc < origin) origin = event.tsc;
+    }
+    const double us_per_cycle = tsc_hz > 0.0 ? 1e6 / tsc_hz : 0.0;
+
+    json << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    json.precision(3);
+    json << std::fixed;
+    bool first = true;
+    for (const trace_event_t& event : events) {
+        json << (first ? "\n" : ",\n");
+        first = false;
+        json << "{\"name\":\"" << phase_name(event.phase) << "\",\"cat\":\""
+             << (event.phase >= TRACE_ECALL_FIRST ? "ecall" : "phase") << "\",\"ph\":\""
+             << (event.kind == TRACE_BEGIN ? "B" : "E") << "\",\"ts\":"
+             << static_cast<double>(event.tsc - origin) * us_per_cycle
+             << ",\"pid\":1,\"tid\":" << event.ring << "}";
+    }
+    json << "\n]}\n";
+    return static_cast<bool>(json);
+}
+
+} // namespace trace_report
@@ -0,0 +1,38 @@
+// app/trace_report.h - Enclave phase traces: collection, breakdown, export
+#ifndef TRACE_REPORT_H
+#define TRACE_REPORT_H
+
+#include "trace_types.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct TracePhaseStats {
+    int phase;
+    uint64_t spans;          // completed BEGIN/END pairs
+    uint64_t total_cycles;   // including nested spans
+    uint64_t self_cycles;    // excluding nested spans
+};
+
+// ocall_trace_export appends every exported ring here, from any thread.
+// Events of one ring stay in the order they were recorded in.
+namespace trace_report {
+    void clear();
+    void append(const trace_event_t* events, size_t count);
+    std::vector<trace_event_t> events();
+
+    const char* phase_name(int phase);
+
+    // Pairs BEGIN/END events per ring; events that pair with nothing (the
+    // trace started or stopped inside a span) are counted in *unmatched
+    std::vector<TracePhaseStats> breakdown(const std::vector<trace_event_t>& events,
+                                           uint64_t* unmatched);
+
+    // Chrome trace-event JSON (chrome://tracing, Perfetto): one thread per
+    // TCS ring, timestamps in microseconds from the first event
+    bool write_chrome_trace(const std::string& path, const std::vector<trace_event_t>& events,
+                            double tsc_hz);
+}
+
+#endif // TRACE_REPORT_H
@@ -0,0 +1,70 @@
+// app/trace_types.h - Phase trace events recorded inside the enclave
+#ifndef TRACE_TYPES_H
+#define TRACE_TYPES_H
+
+#include <stdint.h>
+
+#define TRACE_BEGIN 0
+#define TRACE_END 1
+
+// Events per TCS ring (16 bytes each) and rings per enclave; TCSs beyond
+// TRACE_MAX_RINGS are not traced
+#define TRACE_RING_EVENTS 4096
+#define TRACE_MAX_RINGS 64
+
+// ecall_trace_enable results
+#define TRACE_STATUS_ENABLED 1
+#define TRACE_STATUS_DISABLED 0
+#define TRACE_STATUS_NOT_BUILT (-1)    // enclave built without TRACE=1
+#define TRACE_STATUS_NO_TIMER (-2)     // RDTSC faults in the enclave (SGX1)
+
+// Phases inside a workload
+#define TRACE_PHASE_OCALL 0
+#define TRACE_PHASE_SEAL 1
+#define TRACE_PHASE_UNSEAL 2
+#define TRACE_PHASE_CHECKSUM 3
+#define TRACE_PHASE_ZERO 4             // secure_memzero
+#define TRACE_PHASE_FLUSH 5            // cache_flush; queued flushes drain at ECALL
+                                       // exit, in the ECALL's self time
+#define TRACE_PHASE_COMPUTE 6          // the workload's own arithmetic or accesses
+#define TRACE_PHASE_KEY 7              // seal key derivation or lookup
+#define TRACE_PHASE_EXPORT 8           // ring overflow export, see trace.h
+
+// One per workload ECALL, spanning its whole trusted side; switchless
+// counterparts share the classic ECALL's phase
+#define TRACE_ECALL_FIRST 16
+#define TRACE_ECALL_EMPTY 16
+#define TRACE_ECALL_PING 17
+#define TRACE_ECALL_TRIGGER_OCALL 18
+#define TRACE_ECALL_PURE_OCALL 19
+#define TRACE_ECALL_FILE_READ 20
+#define TRACE_ECALL_SGX_FILE_READ 21
+#define TRACE_ECALL_CREATE_SEALED_FILE 22
+#define TRACE_ECALL_CRYPTO 23
+#define TRACE_ECALL_ALLOC 24
+#define TRACE_ECALL_BATCH 25
+#define TRACE_ECALL_STREAM_SEAL 26
+#define TRACE_ECALL_STREAM_UNSEAL 27
+#define TRACE_ECALL_FILE_READ_RING 28
+#define TRACE_ECALL_FILE_READ_MARSHALLED 29
+#define TRACE_ECALL_MARSHAL 30
+#define TRACE_ECALL_MARSHAL_OCALL 31
+#define TRACE_ECALL_WORKING_SET_PREPARE 32
+#define TRACE_ECALL_WORKING_SET_TOUCH 33
+#define TRACE_ECALL_SESSION_KEY_ROTATE 34
+#define TRACE_ECALL_SESSION_SEAL 35
+#define TRACE_ECALL_SESSION_UNSEAL 36
+#define TRACE_ECALL_CRYPTO_SUITE 37
+#define TRACE_ECALL_MEMOPS 38
+#define TRACE_ECALL_FLUSH_BENCH 39
+#define TRACE_PHASE_COUNT 40
+
+typedef struct {
+    uint64_t tsc;
+    uint16_t phase;      // TRACE_PHASE_* or TRACE_ECALL_*
+    uint8_t kind;        // TRACE_BEGIN or TRACE_END
+    uint8_t reserved;
+    uint32_t ring;       // TCS ring the event was recorded in
+} trace_event_t;
+
+#endif // TRACE_TYPES_H
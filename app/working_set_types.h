@@ -0,0 +1,12 @@
+// app/working_set_types.h - Access patterns for the EPC working-set sweep
+#ifndef WORKING_SET_TYPES_H
+#define WORKING_SET_TYPES_H
+
+#define WORKING_SET_SEQUENTIAL 0
+#define WORKING_SET_RANDOM 1
+#define WORKING_SET_CHASE 2
+#define WORKING_SET_PATTERN_COUNT 3
+
+#define WORKING_SET_LINE_SIZE 64
+
+#endif // WORKING_SET_TYPES_H
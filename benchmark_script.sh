@@ -4,11 +4,6 @@
 ITERATIONS=100000
 OUTPUT="benchmark_results.csv"
 
-echo "test_type,mitigations,iterations,total_time_ms,time_per_op_us,total_cycles,cycles_per_op" > $OUTPUT
-
-echo "Creating test file..."
-dd if=/dev/urandom of=test.txt bs=1024 count=100 2>/dev/null
-
 TESTS=("ecall" "pure_ocall" "pingpong" "untrusted_file" "sealed_file" "crypto")
 
 MITIGATION_SETS=(
@@ -32,24 +27,169 @@ fi
 
 echo "✓ Build successful. Starting benchmarks..."
 
-# Create sealed test file first
-echo "Setting up sealed test files..."
-./sgx_benchmark -s -f test.txt
+# Created after 'make clean', which removes test files
+echo "Creating test file..."
+dd if=/dev/urandom of=test.txt bs=1024 count=100 2>/dev/null
+
+# Run the whole test x mitigation matrix in one process: the enclave is
+# created once and cells run in a seeded random order.
+MATRIX="benchmark_matrix.txt"
+{
+    echo "tests = $(IFS=,; echo "${TESTS[*]}")"
+    echo "mitigations = $(IFS=';'; echo "${MITIGATION_SETS[*]}")"
+    echo "iterations = $ITERATIONS"
+    echo "repetitions = ${REPETITIONS:-5}"
+    echo "file = test.txt"
+} > "$MATRIX"
+
+if ./sgx_benchmark -M "$MATRIX" -o "$OUTPUT"; then
+    echo "✓ Completed"
+else
+    echo "✗ FAILED"
+fi
+
+# The same matrix with the workloads linked in as host code: no enclave
+# transitions, so its overheads are the mitigations' cost alone
+NATIVE_OUTPUT="benchmark_results_native.csv"
+rm -f "$NATIVE_OUTPUT"*
+if make native SGX_DEBUG=0 > /dev/null; then
+    ./sgx_benchmark_native -M "$MATRIX" -o "$NATIVE_OUTPUT" || echo "✗ FAILED (native)"
+else
+    echo "✗ Native backend build failed"
+fi
 
-for test in "${TESTS[@]}"; do
+# untrusted_file under each I/O backend, to separate OS I/O cost from
+# transition and mitigation cost. 'direct' needs a filesystem with O_DIRECT.
+for backend in stdio pread mmap direct; do
+    echo "untrusted_file with I/O backend: $backend"
+    rm -f "io_${backend}.csv"
     for mitigations in "${MITIGATION_SETS[@]}"; do
-        echo "-----------------------------------------------------"
-        echo "Running test: '$test' with mitigations: '$mitigations'"
-
-        if ./sgx_benchmark -t "$test" -i "$ITERATIONS" -m "$mitigations" -o "$OUTPUT"; then
-            echo "✓ Completed"
-        else
-            echo "✗ FAILED"
-        fi
+        ./sgx_benchmark -t untrusted_file -m "$mitigations" -i "$ITERATIONS" -f test.txt \
+            --io-backend "$backend" -o "io_${backend}.csv" > /dev/null || echo "✗ FAILED ($backend, $mitigations)"
+    done
+done
+
+# ECALL/OCALL marshalling cost per buffer direction and payload size
+MARSHAL_OUTPUT="marshal_results.csv"
+rm -f "$MARSHAL_OUTPUT"
+for mitigations in "${MITIGATION_SETS[@]}"; do
+    echo "Marshalling sweep with mitigations: $mitigations"
+    ./sgx_benchmark -t marshal -m "$mitigations" -i 10000 -o "$MARSHAL_OUTPUT" > /dev/null || echo "✗ FAILED"
+done
+
+# EPC pressure: access latency vs working-set size up to 4x the EPC
+WS_OUTPUT="working_set_results.csv"
+rm -f "$WS_OUTPUT"
+for mitigations in "${MITIGATION_SETS[@]}"; do
+    echo "Working-set sweep with mitigations: $mitigations"
+    ./sgx_benchmark -t working_set -m "$mitigations" -i 1000000 -o "$WS_OUTPUT" || echo "✗ FAILED"
+done
+
+# Per-call buffers from the trusted heap vs the per-TCS arena, across
+# thread counts (heap contention shows up as the curve flattens)
+ALLOC_OUTPUT="alloc_results.csv"
+rm -f "$ALLOC_OUTPUT"
+for mitigations in "${MITIGATION_SETS[@]}"; do
+    echo "Allocator scaling with mitigations: $mitigations"
+    for test in alloc untrusted_file; do
+        ./sgx_benchmark -t "$test" -m "$mitigations" -i "$ITERATIONS" -f test.txt -j 8 \
+            --allocator both -o "$ALLOC_OUTPUT" > /dev/null || echo "✗ FAILED ($test)"
     done
 done
 
-echo "Benchmark complete. Results in $OUTPUT"
+# Request-handler paths starting from each cache state; test names get a
+# _<state> suffix. Cold LLC reads twice L2 + LLC per call, so fewer calls.
+CACHE_OUTPUT="cache_state_results.csv"
+rm -f "$CACHE_OUTPUT"
+for state in warm cold_llc cold_l1d tlb; do
+    echo "Cache state: $state"
+    for test in untrusted_file sealed_file crypto; do
+        ./sgx_benchmark -t "$test" -m all -i 200 -f test.txt -p --cache-state "$state" \
+            -o "$CACHE_OUTPUT" > /dev/null || echo "✗ FAILED ($test, $state)"
+    done
+done
+
+# Sealed reads: sgx_unseal_data vs direct AES-GCM with the seal key
+# derived per read or cached for the session
+SEAL_KEY_OUTPUT="seal_key_results.csv"
+rm -f "$SEAL_KEY_OUTPUT"
+for mitigations in "${MITIGATION_SETS[@]}"; do
+    echo "Seal key paths with mitigations: $mitigations"
+    ./sgx_benchmark -t seal_key -m "$mitigations" -i "$ITERATIONS" -f test.txt -o "$SEAL_KEY_OUTPUT" || echo "✗ FAILED"
+done
+
+# sgx_tcrypto throughput (SHA-256, AES-GCM, HMAC, ECDSA) from 64 B to 1 MB
+CRYPTO_OUTPUT="crypto_suite_results.csv"
+rm -f "$CRYPTO_OUTPUT"
+for mitigations in "${MITIGATION_SETS[@]}"; do
+    echo "Crypto suite with mitigations: $mitigations"
+    ./sgx_benchmark -t crypto_suite -m "$mitigations" -i 1000 -o "$CRYPTO_OUTPUT" > /dev/null || echo "✗ FAILED"
+done
+
+# Constant-time copy/zero throughput per implementation (byte, SSE2, AVX2)
+MEMOPS_OUTPUT="memops_results.csv"
+rm -f "$MEMOPS_OUTPUT"
+./sgx_benchmark -t memops -m none -i 10000 -o "$MEMOPS_OUTPUT" || echo "✗ FAILED"
+
+# Cache-line flush cost per strategy (clflush, clflushopt, clwb) and region size
+FLUSH_OUTPUT="flush_results.csv"
+rm -f "$FLUSH_OUTPUT"
+./sgx_benchmark -t flush -m none -i 10000 -o "$FLUSH_OUTPUT" || echo "✗ FAILED"
+
+# Speculation hardening placement: lfence at several loop strides vs
+# index masking with barriers at trust boundaries only
+HARDENING_OUTPUT="hardening_results.csv"
+rm -f "$HARDENING_OUTPUT"
+for mitigations in lfence lfence,mfence all; do
+    echo "Hardening placements with mitigations: $mitigations"
+    ./sgx_benchmark -t hardening -m "$mitigations" -i "$ITERATIONS" -f test.txt -o "$HARDENING_OUTPUT" || echo "✗ FAILED"
+done
+
+# Compiler hardening (retpoline, LVI, register zeroing) per enclave
+# variant, next to the runtime lfence mitigation: each overhead row
+# compares none vs lfence inside one variant, and the console reports each
+# variant against baseline
+VARIANT_OUTPUT="variant_results.csv"
+rm -f "$VARIANT_OUTPUT"
+if make variants SGX_MODE=HW SGX_DEBUG=0 > /dev/null; then
+    for test in "${TESTS[@]}"; do
+        echo "Enclave variants: $test"
+        ./sgx_benchmark -t "$test" -m lfence -i "$ITERATIONS" -f test.txt -r "${REPETITIONS:-5}" \
+            --enclave-variant all -o "$VARIANT_OUTPUT" || echo "✗ FAILED ($test)"
+    done
+else
+    echo "✗ Enclave variant build failed"
+fi
+
+# Enclave load/teardown latency across heap, stack and TCS settings, and
+# the cost of borrowing from a warm enclave pool instead
+STARTUP_OUTPUT="startup_results.csv"
+rm -f "$STARTUP_OUTPUT"
+if make startup-enclaves SGX_MODE=HW SGX_DEBUG=0 > /dev/null; then
+    ./sgx_benchmark -t startup -i 50 -o "$STARTUP_OUTPUT" || echo "✗ FAILED"
+else
+    echo "✗ Startup image build failed"
+fi
+
+# Chunked sealed-file throughput per mitigation set
+STREAM_OUTPUT="stream_results.csv"
+rm -f "$STREAM_OUTPUT"
+for mitigations in "${MITIGATION_SETS[@]}"; do
+    echo "Sealed stream throughput with mitigations: $mitigations"
+    if ! ./sgx_benchmark -t sealed_stream -m "$mitigations" -i 10 --sizes 1M,16M,256M -o "$STREAM_OUTPUT"; then
+        echo "✗ FAILED"
+    fi
+done
+
+echo "Benchmark complete. Results in $OUTPUT, overheads with confidence intervals in $OUTPUT.summary.csv"
+echo "Sealed stream throughput (MB/s) in $STREAM_OUTPUT, per-backend file reads in io_<backend>.csv,"
+echo "marshalling costs in $MARSHAL_OUTPUT, working-set latency in $WS_OUTPUT,"
+echo "heap vs arena allocation scaling in $ALLOC_OUTPUT, cold vs warm cache starts in $CACHE_OUTPUT,"
+echo "seal key paths in $SEAL_KEY_OUTPUT,"
+echo "crypto throughput in $CRYPTO_OUTPUT, constant-time copy/zero throughput in $MEMOPS_OUTPUT,"
+echo "flush strategy costs in $FLUSH_OUTPUT, hardening placements in $HARDENING_OUTPUT,"
+echo "compiler-hardening variants in $VARIANT_OUTPUT, enclave startup latency in $STARTUP_OUTPUT,"
+echo "the matrix without enclave transitions in $NATIVE_OUTPUT"
 echo ""
 echo "Speculation barrier test summary:"
 echo "- lfence: Load fence barrier only"
@@ -0,0 +1,80 @@
+// arena.cpp
+#include "arena.h"
+#include "mitigations.h"
+#include <new>
+
+namespace {
+
+// Plain __thread state: the TLS block of each TCS holds its own arena
+__thread uint8_t* t_allocation = NULL;
+__thread uint8_t* t_base = NULL;
+__thread size_t t_offset = 0;
+
+volatile int g_mode = ALLOCATOR_ARENA;
+
+bool ensure_arena() {
+    if (t_base != NULL) return true;
+    t_allocation = new (std::nothrow) uint8_t[ARENA_CAPACITY + ARENA_ALIGNMENT];
+    if (t_allocation == NULL) return false;
+    uintptr_t aligned = (reinterpret_cast<uintptr_t>(t_allocation) + ARENA_ALIGNMENT - 1) &
+                        ~static_cast<uintptr_t>(ARENA_ALIGNMENT - 1);
+    t_base = reinterpret_cast<uint8_t*>(aligned);
+    t_offset = 0;
+    return true;
+}
+
+void release_range(size_t begin, size_t end) {
+    if (end > begin) {
+        mitigations::raw::volatile_zero(t_base + begin, end - begin);
+    }
+    if (t_offset == end) {
+        t_offset = begin;
+    }
+}
+
+} // namespace
+
+namespace arena {
+
+void set_mode(int new_mode) {
+    g_mode = (new_mode == ALLOCATOR_HEAP) ? ALLOCATOR_HEAP : ALLOCATOR_ARENA;
+}
+
+int mode() {
+    return g_mode;
+}
+
+Buffer::Buffer(size_t size)
+    : data_(NULL), size_(size), begin_(0), end_(0), from_arena_(false) {
+    if (g_mode == ALLOCATOR_ARENA && ensure_arena()) {
+        size_t begin = (t_offset + ARENA_ALIGNMENT - 1) & ~static_cast<size_t>(ARENA_ALIGNMENT - 1);
+        if (begin <= ARENA_CAPACITY && size <= ARENA_CAPACITY - begin) {
+            begin_ = t_offset;
+            end_ = begin + size;
+            t_offset = end_;
+            data_ = t_base + begin;
+            from_arena_ = true;
+            return;
+        }
+    }
+    data_ = new uint8_t[size > 0 ? size : 1];
+}
+
+Buffer::~Buffer() {
+    if (from_arena_) {
+        release_range(begin_, end_);
+        return;
+    }
+    mitigations::raw::volatile_zero(data_, size_);
+    delete[] data_;
+}
+
+Scope::Scope() : mark_(t_offset) {}
+
+Scope::~Scope() {
+    if (t_base != NULL && t_offset > mark_) {
+        release_range(mark_, t_offset);
+    }
+}
+
+} // namespace arena
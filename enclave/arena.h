@@ -0,0 +1,59 @@
+// arena.h - Per-TCS bump allocator for per-call buffers
+#ifndef ARENA_H
+#define ARENA_H
+
+#include "allocator_types.h"
+#include <stddef.h>
+#include <stdint.h>
+
+// Each TCS owns an ARENA_CAPACITY block, allocated on first use and kept
+// for the life of the enclave, so per-call buffers never take the trusted
+// heap lock. Allocations are ARENA_ALIGNMENT-aligned. Every byte is
+// zeroed when its buffer is released, and every workload that takes
+// buffers opens a Scope, which rewinds the arena when its ECALL returns.
+//
+// ecall_set_allocator switches all arena::Buffer users to the trusted heap
+// (new/delete, also zeroed on release) so the two can be compared.
+namespace arena {
+    void set_mode(int mode);
+    int mode();
+
+    // Scoped allocation. Buffers are meant to be locals: a buffer released
+    // out of LIFO order is zeroed at once but its space is only reclaimed
+    // when the enclosing Scope ends.
+    class Buffer {
+    public:
+        explicit Buffer(size_t size);
+        ~Buffer();
+
+        uint8_t* data() const { return data_; }
+        size_t size() const { return size_; }
+        template <class T>
+        T* as() const { return reinterpret_cast<T*>(data_); }
+
+    private:
+        Buffer(const Buffer&);
+        Buffer& operator=(const Buffer&);
+
+        uint8_t* data_;
+        size_t size_;
+        size_t begin_;
+        size_t end_;
+        bool from_arena_;
+    };
+
+    // Rewinds (and zeroes) everything allocated on this TCS since construction
+    class Scope {
+    public:
+        Scope();
+        ~Scope();
+
+    private:
+        Scope(const Scope&);
+        Scope& operator=(const Scope&);
+
+        size_t mark_;
+    };
+}
+
+#endif // ARENA_H
@@ -0,0 +1,167 @@
+// crypto_suite.cpp - sgx_tcrypto primitives over a sweep of message sizes
+#include "enclave_t.h"
+#include "crypto_suite_types.h"
+#include "mitigations.h"
+#include "policy_dispatch.h"
+#include "sgx_tcrypto.h"
+#include "sgx_trts.h"
+#include "trace.h"
+#include <new>
+#include <string.h>
+
+namespace {
+
+// Keys and buffers live for the whole sweep so each timed call measures
+// the primitive, not key setup or page faults
+struct Suite {
+    uint8_t* message;           // random input
+    uint8_t* ciphertext;        // first ciphertext_len bytes of message under decrypt_iv
+    uint8_t* output;
+    size_t capacity;
+    size_t ciphertext_len;
+    uint64_t encrypt_ivs;       // encrypt IVs used under aes_key this sweep
+    sgx_aes_gcm_128bit_key_t aes_key;
+    sgx_aes_gcm_128bit_tag_t decrypt_tag;
+    uint8_t hmac_key[SGX_HMAC256_KEY_SIZE];
+    sgx_ec256_private_t ecdsa_key;
+    sgx_ecc_state_handle_t ecc;
+};
+
+Suite g_suite;
+
+const uint8_t decrypt_iv[12] = {0};
+
+// Each benchmark operation is handled the way a hardened request handler
+// would: a barrier once its (untrusted) length has been checked, a flush
+// of the lines that held secret-dependent output, and scrubbing of any
+// recovered plaintext before the next request.
+template <class P>
+struct CryptoSuiteWorkload {
+    static int run(int op, size_t bytes, uint64_t count) {
+        if (g_suite.message == NULL || bytes > g_suite.capacity) return -1;
+        const uint32_t len = static_cast<uint32_t>(bytes);
+
+        // The ciphertext is produced on the first decrypt call for a size
+        // (the untimed warm-up call), not inside the measured loop
+        if (op == CRYPTO_OP_AES_GCM_DECRYPT && g_suite.ciphertext_len != bytes) {
+            if (sgx_rijndael128GCM_encrypt(&g_suite.aes_key, g_suite.message, len, g_suite.ciphertext,
+                                           decrypt_iv, sizeof(decrypt_iv), NULL, 0,
+                                           &g_suite.decrypt_tag) != SGX_SUCCESS) {
+                return -1;
+            }
+            g_suite.ciphertext_len = bytes;
+        }
+
+        for (uint64_t i = 0; i < count; i++) {
+            P::speculation_barrier();
+            // Flush and scrub spans nest inside, so self time is the primitive
+            TRACE_SPAN(TRACE_PHASE_COMPUTE);
+
+            sgx_status_t ret = SGX_ERROR_INVALID_PARAMETER;
+            size_t output_len = 0;
+            switch (op) {
+                case CRYPTO_OP_SHA256:
+                    ret = sgx_sha256_msg(g_suite.message, len,
+                                         reinterpret_cast<sgx_sha256_hash_t*>(g_suite.output));
+                    output_len = sizeof(sgx_sha256_hash_t);
+                    break;
+                case CRYPTO_OP_AES_GCM_ENCRYPT: {
+                    // Sweep-wide counter IV, never reused under aes_key; it
+                    // starts at 1 because decrypt_iv (all zero) is taken
+                    const uint64_t iv_counter = ++g_suite.encrypt_ivs;
+                    uint8_t iv[12] = {0};
+                    memcpy(iv, &iv_counter, sizeof(iv_counter));
+                    sgx_aes_gcm_128bit_tag_t tag;
+                    ret = sgx_rijndael128GCM_encrypt(&g_suite.aes_key, g_suite.message, len,
+                                                     g_suite.output, iv, sizeof(iv), NULL, 0, &tag);
+                    output_len = bytes;
+                    break;
+                }
+                case CRYPTO_OP_AES_GCM_DECRYPT:
+                    ret = sgx_rijndael128GCM_decrypt(&g_suite.aes_key, g_suite.ciphertext, len,
+                                                     g_suite.output, decrypt_iv, sizeof(decrypt_iv),
+                                                     NULL, 0, &g_suite.decrypt_tag);
+                    output_len = bytes;
+                    break;
+                case CRYPTO_OP_HMAC_SHA256:
+                    ret = sgx_hmac_sha256_msg(g_suite.message, static_cast<int>(len),
+                                              g_suite.hmac_key, sizeof(g_suite.hmac_key),
+                                              g_suite.output, SGX_HMAC256_MAC_SIZE);
+                    output_len = SGX_HMAC256_MAC_SIZE;
+                    break;
+                case CRYPTO_OP_ECDSA_SIGN:
+                    ret = sgx_ecdsa_sign(g_suite.message, len, &g_suite.ecdsa_key,
+                                         reinterpret_cast<sgx_ec256_signature_t*>(g_suite.output),
+                                         g_suite.ecc);
+                    output_len = sizeof(sgx_ec256_signature_t);
+                    break;
+                default:
+                    break;
+            }
+            if (ret != SGX_SUCCESS) return -1;
+
+            if (P::cache_enabled()) {
+                TRACE_SPAN(TRACE_PHASE_FLUSH);
+                P::cache_flush(g_suite.output, output_len);
+            }
+            if (op == CRYPTO_OP_AES_GCM_DECRYPT && P::constant_time_enabled()) {
+                TRACE_SPAN(TRACE_PHASE_ZERO);
+                P::secure_memzero(g_suite.output, output_len);
+            }
+        }
+
+        if (P::memory_enabled()) {
+            P::memory_barrier();
+        }
+        return 0;
+    }
+};
+
+} // namespace
+
+void ecall_crypto_suite_release() {
+    delete[] g_suite.message;
+    delete[] g_suite.ciphertext;
+    if (g_suite.output != NULL) {
+        mitigations::raw::volatile_zero(g_suite.output, g_suite.capacity);
+        delete[] g_suite.output;
+    }
+    if (g_suite.ecc != NULL) {
+        sgx_ecc256_close_context(g_suite.ecc);
+    }
+    mitigations::raw::volatile_zero(&g_suite, sizeof(g_suite));
+}
+
+// Allocates the buffers for messages up to max_bytes and generates the
+// AES, HMAC and ECDSA keys
+int ecall_crypto_suite_prepare(size_t max_bytes) {
+    ecall_crypto_suite_release();
+    if (max_bytes == 0 || max_bytes > CRYPTO_SUITE_MAX_MESSAGE) return -1;
+
+    g_suite.capacity = max_bytes;
+    g_suite.ciphertext_len = SIZE_MAX;
+    g_suite.message = new (std::nothrow) uint8_t[max_bytes];
+    g_suite.ciphertext = new (std::nothrow) uint8_t[max_bytes];
+    g_suite.output = new (std::nothrow) uint8_t[max_bytes];
+    if (g_suite.message == NULL || g_suite.ciphertext == NULL || g_suite.output == NULL) {
+        ecall_crypto_suite_release();
+        return -1;
+    }
+
+    sgx_ec256_public_t ecdsa_public;
+    if (sgx_read_rand(g_suite.message, max_bytes) != SGX_SUCCESS ||
+        sgx_read_rand(g_suite.aes_key, sizeof(g_suite.aes_key)) != SGX_SUCCESS ||
+        sgx_read_rand(g_suite.hmac_key, sizeof(g_suite.hmac_key)) != SGX_SUCCESS ||
+        sgx_ecc256_open_context(&g_suite.ecc) != SGX_SUCCESS ||
+        sgx_ecc256_create_key_pair(&g_suite.ecdsa_key, &ecdsa_public, g_suite.ecc) != SGX_SUCCESS) {
+        ecall_crypto_suite_release();
+        return -1;
+    }
+    return 0;
+}
+
+int ecall_crypto_suite_run(int op, size_t bytes, uint64_t count) {
+    TRACE_SPAN(TRACE_ECALL_CRYPTO_SUITE);
+    if (op < 0 || op >= CRYPTO_OP_COUNT) return -1;
+    return policy_dispatch::run<CryptoSuiteWorkload>(op, bytes, count);
+}
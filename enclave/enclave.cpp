@@ -1,8 +1,13 @@
 // enclave.cpp
 
 #include "enclave_t.h"
+#include "arena.h"
 #include "mitigations.h"
 #include "mitigation_config.h"
+#include "policy_dispatch.h"
+#include "batch_types.h"
+#include "trace.h"
+#include "trusted_timer.h"
 #include "sgx_tseal.h"
 #include <string.h>
 
@@ -23,165 +28,469 @@ void ecall_set_mitigation_config(const MitigationConfig* config) {
     set_enclave_config(config);
 }
 
+int ecall_probe_trusted_timer(uint64_t* overhead_cycles) {
+    *overhead_cycles = 0;
+    trusted_timer::probe();
+    if (!trusted_timer::available()) return 0;
+
+    uint64_t best = UINT64_MAX;
+    for (int i = 0; i < 1000; i++) {
+        uint64_t begin = trusted_timer::start();
+        uint64_t end = trusted_timer::stop();
+        if (end - begin < best) best = end - begin;
+    }
+    *overhead_cycles = best;
+    return 1;
+}
+
 void apply_speculation_mitigations() {
     mitigations::lfence_barrier();
     mitigations::mfence_barrier();
 }
 
-void ecall_empty() {
-    if (g_enclave_config.lfence_barrier || g_enclave_config.mfence_barrier) {
-        apply_speculation_mitigations();
-    }
+typedef sgx_status_t (*read_file_ocall_t)(size_t* retval, const char* filename,
+                                           char* buf, size_t buf_len);
 
-    perform_stable_workload();
+// Workloads are templates over a mitigation policy P (see
+// mitigation_policies.h). Each ECALL goes through policy_dispatch::run,
+// which picks either the runtime-flag policy or the StaticPolicy that
+// matches the current config.
 
-    if (g_enclave_config.memory_barriers) {
-        mitigations::memory_barrier();
+template <class P>
+struct EmptyWorkload {
+    static void run() {
+        if (P::lfence_enabled() || P::mfence_enabled()) {
+            P::speculation_barrier();
+        }
+
+        {
+            TRACE_SPAN(TRACE_PHASE_COMPUTE);
+            perform_stable_workload();
+        }
+
+        if (P::memory_enabled()) {
+            P::memory_barrier();
+        }
+    }
+};
+
+template <class P>
+struct PingWorkload {
+    static void run(int iteration, sgx_status_t (*pong)(int)) {
+        P::speculation_barrier();
+        P::flush_boundary();
+        TRACE_SPAN(TRACE_PHASE_OCALL);
+        pong(iteration);
+    }
+};
+
+template <class P>
+struct PureOcallWorkload {
+    static void run(int iterations, sgx_status_t (*ocall)()) {
+        P::speculation_barrier();
+
+        for (int i = 0; i < iterations; i++) {
+            P::flush_boundary();
+            {
+                TRACE_SPAN(TRACE_PHASE_OCALL);
+                ocall();
+            }
+            if (i % 100 == 0) {
+                P::speculation_barrier();
+            }
+        }
+    }
+};
+
+// Checksums file data returned by an OCALL and scrubs the buffer afterwards.
+// bytes_read comes from untrusted code and is clamped to the buffer capacity;
+// under index masking the loads are also clamped, so a mispredicted clamp
+// cannot read past the buffer.
+template <class P>
+static uint32_t checksum_file_buffer(char* buffer, size_t capacity, size_t bytes_read) {
+    if (bytes_read > capacity) bytes_read = capacity;
+    P::boundary_barrier();
+
+    volatile uint32_t checksum = 0;
+    {
+        TRACE_SPAN(TRACE_PHASE_CHECKSUM);
+        for (size_t i = 0; i < bytes_read; i++) {
+            checksum += (unsigned char)buffer[P::index_nospec(i, capacity)];
+            P::loop_barrier(i);
+        }
     }
-}
 
-void ecall_ping(int iteration) {
-    apply_speculation_mitigations();
-    pong_ocall(iteration);
+    if (P::cache_enabled()) {
+        TRACE_SPAN(TRACE_PHASE_FLUSH);
+        P::cache_flush(buffer, bytes_read);
+    }
+    if (P::constant_time_enabled()) {
+        TRACE_SPAN(TRACE_PHASE_ZERO);
+        P::secure_memzero(buffer, capacity);
+    }
+    return checksum;
 }
 
-void ecall_trigger_ocall() {
-    apply_speculation_mitigations();
-    empty_ocall();
-    apply_speculation_mitigations();
-}
+template <class P>
+struct FileReadWorkload {
+    static void run(const char* filename, read_file_ocall_t read_file) {
+        arena::Scope scope;
+        P::speculation_barrier();
 
-void ecall_setup_ocall_benchmark() {
-    apply_speculation_mitigations();
-}
+        arena::Buffer buffer(8192);
+        char* data = buffer.as<char>();
+        size_t bytes_read = 0;
+        memset(data, 0, buffer.size());
 
-void ecall_measure_pure_ocall(int iterations) {
-    apply_speculation_mitigations();
+        if (P::cache_enabled()) {
+            TRACE_SPAN(TRACE_PHASE_FLUSH);
+            P::cache_flush(data, buffer.size());
+        }
+        P::flush_boundary();
+        {
+            TRACE_SPAN(TRACE_PHASE_OCALL);
+            read_file(&bytes_read, filename, data, buffer.size());
+        }
 
-    for (int i = 0; i < iterations; i++) {
-        empty_ocall();
-        if (i % 100 == 0) {
-            apply_speculation_mitigations();
+        if (bytes_read > 0) {
+            checksum_file_buffer<P>(data, buffer.size(), bytes_read);
         }
     }
-}
+};
+
+template <class P>
+struct SealedReadWorkload {
+    static void run(const char* filename) {
+        arena::Scope scope;
+        P::speculation_barrier();
+
+        const size_t plain_size = 4096;
+        const size_t sealed_overhead = sgx_calc_sealed_data_size(0, plain_size);
+        arena::Buffer sealed_buffer(sealed_overhead);
+        size_t sealed_bytes_read = 0;
+
+        if (P::cache_enabled()) {
+            TRACE_SPAN(TRACE_PHASE_FLUSH);
+            P::cache_flush(sealed_buffer.data(), sealed_buffer.size());
+        }
+        P::flush_boundary();
+        {
+            TRACE_SPAN(TRACE_PHASE_OCALL);
+            ocall_read_sealed_file(&sealed_bytes_read, filename, sealed_buffer.data(),
+                                   sealed_buffer.size());
+        }
+        P::boundary_barrier();
+
+        if (sealed_bytes_read > 0 && sealed_bytes_read <= sealed_buffer.size()) {
+            arena::Buffer unsealed_buffer(plain_size);
+            uint32_t unsealed_len = static_cast<uint32_t>(plain_size);
+            memset(unsealed_buffer.data(), 0, plain_size);
+
+            sgx_status_t ret;
+            {
+                TRACE_SPAN(TRACE_PHASE_UNSEAL);
+                ret = sgx_unseal_data(
+                    sealed_buffer.as<const sgx_sealed_data_t>(),
+                    NULL, NULL,
+                    unsealed_buffer.data(), &unsealed_len
+                );
+            }
 
-void ecall_file_read(const char* filename) {
-    apply_speculation_mitigations();
+            if (ret == SGX_SUCCESS && unsealed_len > 0) {
+                {
+                    TRACE_SPAN(TRACE_PHASE_CHECKSUM);
+                    volatile uint32_t checksum = 0;
+                    for (size_t i = 0; i < unsealed_len; i++) {
+                        checksum += unsealed_buffer.data()[P::index_nospec(i, plain_size)];
+                        P::loop_barrier(i);
+                    }
+                }
 
-    char buffer[8192] = {0};
-    size_t bytes_read = 0;
+                TRACE_SPAN(TRACE_PHASE_ZERO);
+                P::secure_memzero(unsealed_buffer.data(), plain_size);
+            }
+        }
 
-    mitigations::cache_flush(buffer, sizeof(buffer));
-    ocall_read_file(&bytes_read, filename, buffer, sizeof(buffer));
+        TRACE_SPAN(TRACE_PHASE_ZERO);
+        P::secure_memzero(sealed_buffer.data(), sealed_buffer.size());
+    }
+};
+
+template <class P>
+struct CryptoWorkload {
+    static void run() {
+        arena::Scope scope;
+        P::speculation_barrier();
+
+        const size_t data_size = 4096;
+        arena::Buffer storage(data_size);
+        char* buffer = storage.as<char>();
+        char hash_output[32];
+        TRACE_SPAN(TRACE_PHASE_COMPUTE);
+
+        for (size_t i = 0; i < data_size; i++) {
+            buffer[i] = (char)(i * 17 + 42);
+        }
 
-    if (bytes_read > 0) {
-        volatile uint32_t checksum = 0;
-        for (size_t i = 0; i < bytes_read; i++) {
-            checksum += (unsigned char)buffer[i];
-            if (i % 64 == 0) {
-                apply_speculation_mitigations();
+        // Fixed bounds, so no index masking and half the barrier rate
+        uint32_t hash = 0x12345678;
+        for (size_t i = 0; i < data_size; i++) {
+            hash = ((hash << 5) + hash) + (unsigned char)buffer[i];
+            P::loop_barrier(i, 2);
+        }
+
+        for (int round = 0; round < 100; round++) {
+            for (size_t i = 0; i < 32; i++) {
+                hash_output[i] = (char)((hash >> (i % 32)) ^ (round * i));
             }
+            hash = ((hash << 3) + hash) ^ round;
         }
 
-        if (g_enclave_config.cache_flushing) {
-            mitigations::cache_flush(buffer, bytes_read);
+        if (P::cache_enabled()) {
+            TRACE_SPAN(TRACE_PHASE_FLUSH);
+            P::cache_flush(buffer, data_size);
+            P::cache_flush(hash_output, 32);
         }
-        if (g_enclave_config.constant_time_ops) {
-            mitigations::secure_memzero(buffer, sizeof(buffer));
+        TRACE_SPAN(TRACE_PHASE_ZERO);
+        P::secure_memzero(buffer, data_size);
+    }
+};
+
+// Allocation churn of a typical ECALL: a file buffer, a sealed-data buffer
+// and a small scratch buffer, each written once per cache line and then
+// released. Compares the per-TCS arena against the trusted heap.
+template <class P>
+struct AllocWorkload {
+    static void run() {
+        arena::Scope scope;
+        P::speculation_barrier();
+
+        const size_t sizes[] = { 8192, 4096 + 560, 600 };
+        arena::Buffer file_buffer(sizes[0]);
+        arena::Buffer sealed_buffer(sizes[1]);
+        arena::Buffer scratch(sizes[2]);
+        arena::Buffer* buffers[] = { &file_buffer, &sealed_buffer, &scratch };
+
+        TRACE_SPAN(TRACE_PHASE_COMPUTE);
+        for (size_t b = 0; b < 3; b++) {
+            volatile uint8_t* data = buffers[b]->data();
+            for (size_t i = 0; i < buffers[b]->size(); i += ARENA_ALIGNMENT) {
+                data[i] = static_cast<uint8_t>(i);
+            }
+        }
+
+        if (P::memory_enabled()) {
+            P::memory_barrier();
+        }
+    }
+};
+
+// Batched file reads: one OCALL fills up to BATCH_OCALL_MAX_FILES slots.
+template <class P>
+static void batch_file_reads(const batch_request_t* requests, batch_result_t* results,
+                             const size_t* indices, size_t count) {
+    const size_t slot_size = BATCH_FILE_SLOT_SIZE;
+    const size_t group_max = count < BATCH_OCALL_MAX_FILES ? count : BATCH_OCALL_MAX_FILES;
+    arena::Buffer group_storage(group_max * sizeof(batch_request_t));
+    arena::Buffer length_storage(group_max * sizeof(uint64_t));
+    arena::Buffer buffer_storage(group_max * slot_size);
+    batch_request_t* group = group_storage.as<batch_request_t>();
+    uint64_t* lengths = length_storage.as<uint64_t>();
+    char* buffer = buffer_storage.as<char>();
+
+    for (size_t start = 0; start < count; start += BATCH_OCALL_MAX_FILES) {
+        size_t n = count - start;
+        if (n > BATCH_OCALL_MAX_FILES) n = BATCH_OCALL_MAX_FILES;
+
+        for (size_t k = 0; k < n; k++) {
+            group[k] = requests[indices[start + k]];
+            group[k].filename[BATCH_MAX_FILENAME - 1] = '\0';
+            lengths[k] = 0;
+        }
+
+        if (P::cache_enabled()) {
+            TRACE_SPAN(TRACE_PHASE_FLUSH);
+            P::cache_flush(buffer, n * slot_size);
+        }
+        P::flush_boundary();
+        sgx_status_t ret;
+        {
+            TRACE_SPAN(TRACE_PHASE_OCALL);
+            ret = ocall_read_files_batch(group, lengths, n, buffer, n * slot_size, slot_size);
+        }
+
+        for (size_t k = 0; k < n; k++) {
+            batch_result_t& result = results[indices[start + k]];
+            if (ret != SGX_SUCCESS || lengths[k] == 0) {
+                result.status = BATCH_STATUS_IO_ERROR;
+                continue;
+            }
+            result.value = checksum_file_buffer<P>(buffer + k * slot_size, slot_size,
+                                                   static_cast<size_t>(lengths[k]));
         }
     }
 }
 
-void ecall_sgx_file_read(const char* filename) {
-    apply_speculation_mitigations();
+// Batched pings: the per-op mitigations run in the enclave, then a single
+// OCALL delivers every pong.
+template <class P>
+static void batch_pings(const batch_request_t* requests, batch_result_t* results,
+                        const size_t* indices, size_t count) {
+    arena::Buffer storage(count * sizeof(int));
+    int* iterations = storage.as<int>();
+    for (size_t k = 0; k < count; k++) {
+        P::speculation_barrier();
+        iterations[k] = requests[indices[k]].arg;
+        results[indices[k]].value = static_cast<uint32_t>(iterations[k]);
+    }
+    P::flush_boundary();
+    TRACE_SPAN(TRACE_PHASE_OCALL);
+    pong_ocall_batch(iterations, count);
+}
 
-    const size_t plain_size = 4096;
-    const size_t sealed_overhead = sgx_calc_sealed_data_size(0, plain_size);
-    uint8_t sealed_buffer[sealed_overhead];
-    size_t sealed_bytes_read = 0;
+template <class P>
+struct BatchWorkload {
+    static void run(const batch_request_t* requests, batch_result_t* results, size_t count) {
+        arena::Scope scope;
+        P::speculation_barrier();
+
+        arena::Buffer ping_storage(count * sizeof(size_t));
+        arena::Buffer file_storage(count * sizeof(size_t));
+        size_t* ping_indices = ping_storage.as<size_t>();
+        size_t* file_indices = file_storage.as<size_t>();
+        size_t pings = 0, files = 0;
+
+        for (size_t i = 0; i < count; i++) {
+            results[i].status = BATCH_STATUS_OK;
+            results[i].value = 0;
+            switch (requests[i].op) {
+                case BATCH_OP_EMPTY:
+                    EmptyWorkload<P>::run();
+                    break;
+                case BATCH_OP_PING:
+                    ping_indices[pings++] = i;
+                    break;
+                case BATCH_OP_FILE_READ:
+                    file_indices[files++] = i;
+                    break;
+                case BATCH_OP_CRYPTO:
+                    CryptoWorkload<P>::run();
+                    break;
+                default:
+                    results[i].status = BATCH_STATUS_BAD_OP;
+                    break;
+            }
+        }
 
-    mitigations::cache_flush(sealed_buffer, sizeof(sealed_buffer));
-    ocall_read_sealed_file(&sealed_bytes_read, filename, sealed_buffer, sizeof(sealed_buffer));
+        if (pings > 0) batch_pings<P>(requests, results, ping_indices, pings);
+        if (files > 0) batch_file_reads<P>(requests, results, file_indices, files);
+    }
+};
 
-    if (sealed_bytes_read > 0 && sealed_bytes_read <= sizeof(sealed_buffer)) {
-        char unsealed_buffer[plain_size] = {0};
-        uint32_t unsealed_len = sizeof(unsealed_buffer);
+void ecall_empty() {
+    TRACE_SPAN(TRACE_ECALL_EMPTY);
+    policy_dispatch::run<EmptyWorkload>();
+}
 
-        sgx_status_t ret = sgx_unseal_data(
-            (const sgx_sealed_data_t*)sealed_buffer,
-            NULL, NULL,
-            (uint8_t*)unsealed_buffer, &unsealed_len
-        );
+void ecall_empty_switchless() {
+    TRACE_SPAN(TRACE_ECALL_EMPTY);
+    policy_dispatch::run<EmptyWorkload>();
+}
 
-        if (ret == SGX_SUCCESS && unsealed_len > 0) {
-            volatile uint32_t checksum = 0;
-            for (size_t i = 0; i < unsealed_len; i++) {
-                checksum += (unsigned char)unsealed_buffer[i];
-                if (i % 64 == 0) {
-                    apply_speculation_mitigations();
-                }
-            }
+void ecall_ping(int iteration) {
+    TRACE_SPAN(TRACE_ECALL_PING);
+    policy_dispatch::run<PingWorkload>(iteration, pong_ocall);
+}
 
-            mitigations::secure_memzero(unsealed_buffer, sizeof(unsealed_buffer));
-        }
+void ecall_ping_switchless(int iteration) {
+    TRACE_SPAN(TRACE_ECALL_PING);
+    policy_dispatch::run<PingWorkload>(iteration, pong_ocall_switchless);
+}
+
+void ecall_trigger_ocall() {
+    TRACE_SPAN(TRACE_ECALL_TRIGGER_OCALL);
+    apply_speculation_mitigations();
+    {
+        TRACE_SPAN(TRACE_PHASE_OCALL);
+        empty_ocall();
     }
+    apply_speculation_mitigations();
+}
 
-    mitigations::secure_memzero(sealed_buffer, sizeof(sealed_buffer));
+void ecall_setup_ocall_benchmark() {
+    apply_speculation_mitigations();
+}
+
+void ecall_measure_pure_ocall(int iterations) {
+    TRACE_SPAN(TRACE_ECALL_PURE_OCALL);
+    policy_dispatch::run<PureOcallWorkload>(iterations, empty_ocall);
+}
+
+void ecall_measure_pure_ocall_switchless(int iterations) {
+    TRACE_SPAN(TRACE_ECALL_PURE_OCALL);
+    policy_dispatch::run<PureOcallWorkload>(iterations, empty_ocall_switchless);
+}
+
+void ecall_file_read(const char* filename) {
+    TRACE_SPAN(TRACE_ECALL_FILE_READ);
+    policy_dispatch::run<FileReadWorkload>(filename, ocall_read_file);
+}
+
+void ecall_file_read_switchless(const char* filename) {
+    TRACE_SPAN(TRACE_ECALL_FILE_READ);
+    policy_dispatch::run<FileReadWorkload>(filename, ocall_read_file_switchless);
+}
+
+void ecall_sgx_file_read(const char* filename) {
+    TRACE_SPAN(TRACE_ECALL_SGX_FILE_READ);
+    policy_dispatch::run<SealedReadWorkload>(filename);
 }
 
 void ecall_create_sealed_file(const char* filename, const char* data, size_t data_len) {
+    TRACE_SPAN(TRACE_ECALL_CREATE_SEALED_FILE);
     apply_speculation_mitigations();
+    mitigations::FlushScope flushes;
+    arena::Scope scope;
 
     const size_t max_data_len = 4096;
     uint32_t actual_len = (data_len > max_data_len) ? max_data_len : static_cast<uint32_t>(data_len);
 
     uint32_t sealed_size = sgx_calc_sealed_data_size(0, actual_len);
-    uint8_t* sealed_buffer = new uint8_t[sealed_size];
+    arena::Buffer sealed_buffer(sealed_size);
 
-    if (sealed_buffer) {
-        sgx_status_t ret = sgx_seal_data(
+    sgx_status_t ret;
+    {
+        TRACE_SPAN(TRACE_PHASE_SEAL);
+        ret = sgx_seal_data(
             0, NULL,
             actual_len, (const uint8_t*)data,
-            sealed_size, (sgx_sealed_data_t*)sealed_buffer
+            sealed_size, sealed_buffer.as<sgx_sealed_data_t>()
         );
+    }
 
-        if (ret == SGX_SUCCESS) {
-            int write_result = 0;
-            ocall_write_sealed_file(&write_result, filename, sealed_buffer, sealed_size);
-        }
-
-        delete[] sealed_buffer;
+    if (ret == SGX_SUCCESS) {
+        mitigations::raw::flush_drain();
+        TRACE_SPAN(TRACE_PHASE_OCALL);
+        int write_result = 0;
+        ocall_write_sealed_file(&write_result, filename, sealed_buffer.data(), sealed_size);
     }
 }
 
 void ecall_crypto_workload() {
-    apply_speculation_mitigations();
-
-    const size_t data_size = 4096;
-    char buffer[data_size];
-    char hash_output[32];
-
-    for (size_t i = 0; i < data_size; i++) {
-        buffer[i] = (char)(i * 17 + 42);
-    }
+    TRACE_SPAN(TRACE_ECALL_CRYPTO);
+    policy_dispatch::run<CryptoWorkload>();
+}
 
-    uint32_t hash = 0x12345678;
-    for (size_t i = 0; i < data_size; i++) {
-        hash = ((hash << 5) + hash) + (unsigned char)buffer[i];
-        if (i % 128 == 0) {
-            apply_speculation_mitigations();
-        }
-    }
+void ecall_set_allocator(int mode) {
+    arena::set_mode(mode);
+}
 
-    for (int round = 0; round < 100; round++) {
-        for (size_t i = 0; i < 32; i++) {
-            hash_output[i] = (char)((hash >> (i % 32)) ^ (round * i));
-        }
-        hash = ((hash << 3) + hash) ^ round;
-    }
+void ecall_alloc_workload() {
+    TRACE_SPAN(TRACE_ECALL_ALLOC);
+    policy_dispatch::run<AllocWorkload>();
+}
 
-    mitigations::cache_flush(buffer, data_size);
-    mitigations::cache_flush(hash_output, 32);
-    mitigations::secure_memzero(buffer, data_size);
+void ecall_batch(const batch_request_t* requests, batch_result_t* results, size_t count) {
+    TRACE_SPAN(TRACE_ECALL_BATCH);
+    policy_dispatch::run<BatchWorkload>(requests, results, count);
 }
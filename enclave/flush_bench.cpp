@@ -0,0 +1,71 @@
+// flush_bench.cpp - Cost of the cache flush strategies across region sizes
+#include "enclave_t.h"
+#include "flush_types.h"
+#include "mitigations.h"
+#include "trace.h"
+#include <new>
+
+namespace {
+
+struct FlushBuffer {
+    uint8_t* data;
+    size_t capacity;
+};
+
+FlushBuffer g_flush_buffer = {NULL, 0};
+
+} // namespace
+
+void ecall_flush_bench_release() {
+    delete[] g_flush_buffer.data;
+    g_flush_buffer.data = NULL;
+    g_flush_buffer.capacity = 0;
+}
+
+// Each operation dirties every line of `bytes`, then flushes the region
+// the way the workloads do: all of it, then each half again (as
+// secure_memzero and the crypto workload flush the same buffer repeatedly).
+// Batched runs queue the three requests and drain once; unbatched runs
+// flush and fence on every request. Returns -1 if the strategy is not
+// supported here.
+int ecall_flush_benchmark(int strategy, int batched, size_t bytes, uint64_t count) {
+    TRACE_SPAN(TRACE_ECALL_FLUSH_BENCH);
+    if (bytes == 0 || bytes > FLUSH_BENCH_MAX_BYTES) return -1;
+    if (strategy < 0 || strategy >= FLUSH_STRATEGY_COUNT ||
+        !mitigations::raw::flush_supported(strategy)) {
+        return -1;
+    }
+
+    if (bytes > g_flush_buffer.capacity) {
+        ecall_flush_bench_release();
+        g_flush_buffer.data = new (std::nothrow) uint8_t[bytes];
+        if (g_flush_buffer.data == NULL) return -1;
+        g_flush_buffer.capacity = bytes;
+    }
+
+    int previous = mitigations::raw::flush_strategy();
+    mitigations::raw::select_flush(strategy);
+
+    volatile uint8_t* data = g_flush_buffer.data;
+    const size_t half = bytes / 2;
+    TRACE_SPAN(TRACE_PHASE_FLUSH);
+    for (uint64_t i = 0; i < count; i++) {
+        for (size_t offset = 0; offset < bytes; offset += 64) {
+            data[offset] = static_cast<uint8_t>(i + offset);
+        }
+
+        if (batched) {
+            mitigations::raw::cache_flush(g_flush_buffer.data, bytes);
+            mitigations::raw::cache_flush(g_flush_buffer.data, half);
+            mitigations::raw::cache_flush(g_flush_buffer.data + half, bytes - half);
+            mitigations::raw::flush_drain();
+        } else {
+            mitigations::raw::flush_now(g_flush_buffer.data, bytes);
+            mitigations::raw::flush_now(g_flush_buffer.data, half);
+            mitigations::raw::flush_now(g_flush_buffer.data + half, bytes - half);
+        }
+    }
+
+    mitigations::raw::select_flush(previous);
+    return 0;
+}
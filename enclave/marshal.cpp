@@ -0,0 +1,94 @@
+// marshal.cpp - Entry points that only move buffers, for the marshalling sweep
+#include "enclave_t.h"
+#include "arena.h"
+#include "marshal_types.h"
+#include "policy_dispatch.h"
+#include "sgx_trts.h"
+#include "trace.h"
+
+namespace {
+
+// The bodies do no work beyond the per-call mitigations, so the measured
+// cost is the transition plus what the bridge does with the buffer.
+template <class P>
+struct MarshalEcallWorkload {
+    static void run() {
+        P::speculation_barrier();
+        if (P::memory_enabled()) {
+            P::memory_barrier();
+        }
+    }
+};
+
+// Issues `iterations` OCALLs of one direction. In/out directions use an
+// enclave buffer that the bridge copies; user_check hands the untrusted
+// buffer through unchanged, which is the lower bound for shared memory.
+template <class P>
+struct MarshalOcallWorkload {
+    static int run(int direction, uint8_t* untrusted_buf, size_t len, int iterations) {
+        arena::Scope scope;
+        if (len > MARSHAL_MAX_OCALL_SIZE) return -1;
+
+        const bool user_check = direction == MARSHAL_USER_CHECK;
+        if (user_check && len > 0 &&
+            (untrusted_buf == NULL || !sgx_is_outside_enclave(untrusted_buf, len))) {
+            return -1;
+        }
+        arena::Buffer staging(user_check ? 0 : len);
+        uint8_t* buffer = user_check ? untrusted_buf : staging.data();
+        P::speculation_barrier();
+
+        for (int i = 0; i < iterations; i++) {
+            P::flush_boundary();
+            TRACE_SPAN(TRACE_PHASE_OCALL);
+            switch (direction) {
+                case MARSHAL_IN: ocall_marshal_in(buffer, len); break;
+                case MARSHAL_OUT: ocall_marshal_out(buffer, len); break;
+                case MARSHAL_INOUT: ocall_marshal_inout(buffer, len); break;
+                default: ocall_marshal_user_check(buffer, len); break;
+            }
+            if (i % 100 == 0) {
+                P::speculation_barrier();
+            }
+        }
+        return 0;
+    }
+};
+
+} // namespace
+
+void ecall_marshal_in(const uint8_t* buf, size_t len) {
+    TRACE_SPAN(TRACE_ECALL_MARSHAL);
+    (void)buf;
+    (void)len;
+    policy_dispatch::run<MarshalEcallWorkload>();
+}
+
+void ecall_marshal_out(uint8_t* buf, size_t len) {
+    TRACE_SPAN(TRACE_ECALL_MARSHAL);
+    (void)buf;
+    (void)len;
+    policy_dispatch::run<MarshalEcallWorkload>();
+}
+
+void ecall_marshal_inout(uint8_t* buf, size_t len) {
+    TRACE_SPAN(TRACE_ECALL_MARSHAL);
+    (void)buf;
+    (void)len;
+    policy_dispatch::run<MarshalEcallWorkload>();
+}
+
+// A user_check pointer must at least be checked to lie outside the
+// enclave, so that check is part of the measured cost
+int ecall_marshal_user_check(uint8_t* buf, size_t len) {
+    TRACE_SPAN(TRACE_ECALL_MARSHAL);
+    if (len > 0 && (buf == NULL || !sgx_is_outside_enclave(buf, len))) return -1;
+    policy_dispatch::run<MarshalEcallWorkload>();
+    return 0;
+}
+
+int ecall_measure_marshal_ocall(int direction, uint8_t* untrusted_buf, size_t len, int iterations) {
+    TRACE_SPAN(TRACE_ECALL_MARSHAL_OCALL);
+    if (direction < 0 || direction >= MARSHAL_DIRECTION_COUNT) return -1;
+    return policy_dispatch::run<MarshalOcallWorkload>(direction, untrusted_buf, len, iterations);
+}
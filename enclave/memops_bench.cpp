@@ -0,0 +1,61 @@
+// memops_bench.cpp - Throughput of the constant-time copy/zero implementations
+#include "enclave_t.h"
+#include "memops_types.h"
+#include "mitigations.h"
+#include "trace.h"
+#include <new>
+
+namespace {
+
+struct MemopsBuffers {
+    uint8_t* source;
+    uint8_t* dest;
+    size_t capacity;
+};
+
+MemopsBuffers g_buffers = {NULL, NULL, 0};
+
+} // namespace
+
+void ecall_memops_release() {
+    delete[] g_buffers.source;
+    delete[] g_buffers.dest;
+    g_buffers.source = NULL;
+    g_buffers.dest = NULL;
+    g_buffers.capacity = 0;
+}
+
+int ecall_memops_select(int level) {
+    return mitigations::raw::select_memops(level);
+}
+
+// Runs `count` copies or zeroings of `bytes` with the selected level.
+// Buffers grow on demand, so the first call for a size is the warm-up.
+int ecall_memops_run(int op, size_t bytes, uint64_t count) {
+    TRACE_SPAN(TRACE_ECALL_MEMOPS);
+    if ((op != MEMOPS_OP_COPY && op != MEMOPS_OP_ZERO) || bytes > MEMOPS_MAX_BYTES) return -1;
+    if (bytes > g_buffers.capacity) {
+        ecall_memops_release();
+        g_buffers.source = new (std::nothrow) uint8_t[bytes];
+        g_buffers.dest = new (std::nothrow) uint8_t[bytes];
+        if (g_buffers.source == NULL || g_buffers.dest == NULL) {
+            ecall_memops_release();
+            return -1;
+        }
+        g_buffers.capacity = bytes;
+        for (size_t i = 0; i < bytes; i++) {
+            g_buffers.source[i] = static_cast<uint8_t>(i * 31 + 7);
+        }
+    }
+
+    // Whole-loop span: at 64 bytes a span per call would cost more than the call
+    TRACE_SPAN(TRACE_PHASE_COMPUTE);
+    for (uint64_t i = 0; i < count; i++) {
+        if (op == MEMOPS_OP_COPY) {
+            mitigations::raw::volatile_copy(g_buffers.dest, g_buffers.source, bytes);
+        } else {
+            mitigations::raw::volatile_zero(g_buffers.dest, bytes);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,63 @@
+// policy_dispatch.h - Selects a fully specialized workload once per ECALL
+#ifndef POLICY_DISPATCH_H
+#define POLICY_DISPATCH_H
+
+#include "mitigation_policies.h"
+#include <utility>
+
+extern MitigationConfig g_enclave_config;
+
+namespace policy_dispatch {
+    // Bit i of a policy mask enables mitigation i in MitigationConfig order
+    const unsigned POLICY_COUNT = 32;
+
+    inline unsigned mask_of(const MitigationConfig& config) {
+        return (config.lfence_barrier ? 1u : 0u) |
+               (config.mfence_barrier ? 2u : 0u) |
+               (config.cache_flushing ? 4u : 0u) |
+               (config.constant_time_ops ? 8u : 0u) |
+               (config.memory_barriers ? 16u : 0u);
+    }
+
+    template <size_t Mask>
+    using PolicyFor = mitigations::StaticPolicy<(Mask & 1u) != 0, (Mask & 2u) != 0,
+                                                (Mask & 4u) != 0, (Mask & 8u) != 0,
+                                                (Mask & 16u) != 0>;
+
+    template <template <class> class Workload, class... Args>
+    using result_of = decltype(Workload<mitigations::RuntimePolicy>::run(std::declval<Args>()...));
+
+    // Workload<P>::run followed by the ECALL-exit trust boundary: the cache
+    // flushes it queued since its last OCALL are issued when it returns.
+    // Policies without cache flushing add nothing to the call.
+    template <template <class> class Workload, class P, class... Args>
+    struct Entry {
+        static result_of<Workload, Args...> run(Args... args) {
+            mitigations::FlushBoundary<P> boundary;
+            return Workload<P>::run(args...);
+        }
+    };
+
+    template <template <class> class Workload, size_t... Masks, class... Args>
+    inline result_of<Workload, Args...> run_static(std::index_sequence<Masks...>, unsigned mask,
+                                                   Args... args) {
+        typedef result_of<Workload, Args...> (*entry_t)(Args...);
+        static const entry_t table[] = { &Entry<Workload, PolicyFor<Masks>, Args...>::run... };
+        return table[mask](args...);
+    }
+
+    // Runs Workload<P>::run(args...) with P chosen from the current config:
+    // the matching StaticPolicy when static dispatch is on, RuntimePolicy
+    // otherwise. Returns whatever Workload::run returns. Workloads that
+    // take arena buffers open their own arena::Scope.
+    template <template <class> class Workload, class... Args>
+    inline result_of<Workload, Args...> run(Args... args) {
+        if (g_enclave_config.static_dispatch) {
+            return run_static<Workload>(std::make_index_sequence<POLICY_COUNT>(),
+                                        mask_of(g_enclave_config), args...);
+        }
+        return Entry<Workload, mitigations::RuntimePolicy, Args...>::run(args...);
+    }
+}
+
+#endif // POLICY_DISPATCH_H
@@ -0,0 +1,311 @@
+// sealed_stream.cpp - Streaming seal/unseal of chunked sealed files
+#include "enclave_t.h"
+#include "arena.h"
+#include "mitigations.h"
+#include "policy_dispatch.h"
+#include "sealed_stream_format.h"
+#include "sgx_tcrypto.h"
+#include "sgx_trts.h"
+#include "sgx_tseal.h"
+#include "trace.h"
+#include <string.h>
+
+namespace {
+
+// Closes the untrusted stream on every exit path. finish() reports whether
+// queued writes reached the file.
+struct StreamHandle {
+    int handle;
+
+    StreamHandle() : handle(-1) {}
+    ~StreamHandle() { finish(); }
+
+    bool finish() {
+        if (handle < 0) return true;
+        int result = -1;
+        mitigations::raw::flush_drain();
+        sgx_status_t ret = ocall_stream_close(&result, handle);
+        handle = -1;
+        return ret == SGX_SUCCESS && result == 0;
+    }
+};
+
+// Per-call buffer (see arena.h), scrubbed before it is released
+struct ChunkBuffer {
+    arena::Buffer storage;
+    uint8_t* data;
+    size_t size;
+
+    explicit ChunkBuffer(size_t n) : storage(n), data(storage.data()), size(n) {}
+};
+
+struct FileKey {
+    sgx_aes_gcm_128bit_key_t bytes;
+
+    ~FileKey() { mitigations::raw::volatile_zero(bytes, sizeof(bytes)); }
+};
+
+uint64_t chunk_count_for(uint64_t plain_size, uint32_t chunk_size) {
+    return (plain_size + chunk_size - 1) / chunk_size;
+}
+
+void chunk_iv(uint64_t index, uint8_t iv[SEALED_STREAM_IV_SIZE]) {
+    memset(iv, 0, SEALED_STREAM_IV_SIZE);
+    memcpy(iv, &index, sizeof(index));
+}
+
+void chunk_aad(const sealed_stream_header_t& header, uint64_t index, uint32_t length,
+               sealed_stream_chunk_aad_t* aad) {
+    memset(aad, 0, sizeof(*aad));
+    memcpy(aad->file_id, header.file_id, sizeof(aad->file_id));
+    aad->index = index;
+    aad->length = length;
+    aad->final_chunk = (index + 1 == header.chunk_count) ? 1 : 0;
+}
+
+template <class P>
+uint32_t checksum_chunk(const uint8_t* data, size_t len) {
+    TRACE_SPAN(TRACE_PHASE_CHECKSUM);
+    uint32_t checksum = 0;
+    for (size_t i = 0; i < len; i++) {
+        checksum += data[i];
+    }
+    if (P::cache_enabled()) {
+        TRACE_SPAN(TRACE_PHASE_FLUSH);
+        P::cache_flush(data, len);
+    }
+    return checksum;
+}
+
+// Reads a plaintext file through the prefetching stream and writes the
+// header followed by one [MAC | ciphertext] record per chunk.
+template <class P>
+struct StreamSealWorkload {
+    static int run(const char* plain_filename, const char* sealed_filename, uint32_t chunk_size,
+                   uint64_t* plain_bytes, uint32_t* checksum) {
+        arena::Scope scope;
+        *plain_bytes = 0;
+        *checksum = 0;
+        P::speculation_barrier();
+
+        if (chunk_size < SEALED_STREAM_MIN_CHUNK || chunk_size > SEALED_STREAM_MAX_CHUNK) {
+            return SEALED_STREAM_BAD_ARG;
+        }
+
+        StreamHandle input;
+        uint64_t plain_size = 0;
+        P::flush_boundary();
+        if (ocall_stream_open_read(&input.handle, plain_filename, NULL, 0, &plain_size) != SGX_SUCCESS ||
+            input.handle < 0) {
+            return SEALED_STREAM_IO_ERROR;
+        }
+
+        sealed_stream_header_t header;
+        memset(&header, 0, sizeof(header));
+        header.magic = SEALED_STREAM_MAGIC;
+        header.version = SEALED_STREAM_VERSION;
+        header.chunk_size = chunk_size;
+        header.chunk_count = chunk_count_for(plain_size, chunk_size);
+        header.plain_size = plain_size;
+
+        FileKey key;
+        if (sgx_read_rand(header.file_id, sizeof(header.file_id)) != SGX_SUCCESS ||
+            sgx_read_rand(key.bytes, sizeof(key.bytes)) != SGX_SUCCESS) {
+            return SEALED_STREAM_CRYPTO_ERROR;
+        }
+
+        const uint32_t mac_text_size = SEALED_STREAM_HEADER_MAC_TEXT_SIZE;
+        uint32_t blob_size = sgx_calc_sealed_data_size(mac_text_size, sizeof(key.bytes));
+        if (blob_size == UINT32_MAX || blob_size > SEALED_STREAM_KEY_BLOB_SIZE) {
+            return SEALED_STREAM_CRYPTO_ERROR;
+        }
+        header.key_blob_size = blob_size;
+        if (sgx_seal_data(mac_text_size, reinterpret_cast<const uint8_t*>(&header),
+                          sizeof(key.bytes), key.bytes,
+                          blob_size, reinterpret_cast<sgx_sealed_data_t*>(header.key_blob)) != SGX_SUCCESS) {
+            return SEALED_STREAM_CRYPTO_ERROR;
+        }
+
+        StreamHandle output;
+        int write_result = -1;
+        P::flush_boundary();
+        if (ocall_stream_open_write(&output.handle, sealed_filename) != SGX_SUCCESS || output.handle < 0 ||
+            ocall_stream_write(&write_result, output.handle, reinterpret_cast<const uint8_t*>(&header),
+                               sizeof(header)) != SGX_SUCCESS || write_result != 0) {
+            return SEALED_STREAM_IO_ERROR;
+        }
+
+        ChunkBuffer plain(chunk_size);
+        ChunkBuffer record(SEALED_STREAM_MAC_SIZE + static_cast<size_t>(chunk_size));
+        uint32_t sum = 0;
+
+        for (uint64_t index = 0; index < header.chunk_count; index++) {
+            P::speculation_barrier();
+
+            uint64_t remaining = plain_size - index * chunk_size;
+            uint32_t length = remaining < chunk_size ? static_cast<uint32_t>(remaining) : chunk_size;
+
+            size_t bytes_read = 0;
+            sgx_status_t ret;
+            P::flush_boundary();
+            {
+                TRACE_SPAN(TRACE_PHASE_OCALL);
+                ret = ocall_stream_read(&bytes_read, input.handle, plain.data, chunk_size);
+            }
+            if (ret != SGX_SUCCESS || bytes_read < length) {
+                return SEALED_STREAM_IO_ERROR;
+            }
+            sum += checksum_chunk<P>(plain.data, length);
+
+            uint8_t iv[SEALED_STREAM_IV_SIZE];
+            sealed_stream_chunk_aad_t aad;
+            chunk_iv(index, iv);
+            chunk_aad(header, index, length, &aad);
+
+            {
+                TRACE_SPAN(TRACE_PHASE_SEAL);
+                ret = sgx_rijndael128GCM_encrypt(
+                    &key.bytes, plain.data, length, record.data + SEALED_STREAM_MAC_SIZE,
+                    iv, SEALED_STREAM_IV_SIZE,
+                    reinterpret_cast<const uint8_t*>(&aad), sizeof(aad),
+                    reinterpret_cast<sgx_aes_gcm_128bit_tag_t*>(record.data));
+            }
+            if (ret != SGX_SUCCESS) {
+                return SEALED_STREAM_CRYPTO_ERROR;
+            }
+
+            P::flush_boundary();
+            {
+                TRACE_SPAN(TRACE_PHASE_OCALL);
+                ret = ocall_stream_write(&write_result, output.handle, record.data,
+                                         SEALED_STREAM_MAC_SIZE + static_cast<size_t>(length));
+            }
+            if (ret != SGX_SUCCESS || write_result != 0) {
+                return SEALED_STREAM_IO_ERROR;
+            }
+        }
+
+        if (P::constant_time_enabled()) {
+            TRACE_SPAN(TRACE_PHASE_ZERO);
+            P::secure_memzero(plain.data, plain.size);
+        }
+        if (!output.finish()) {
+            return SEALED_STREAM_IO_ERROR;
+        }
+
+        *plain_bytes = plain_size;
+        *checksum = sum;
+        return SEALED_STREAM_OK;
+    }
+};
+
+// Validates the header, unseals the file key and decrypts the records in
+// order. Records are copied into enclave memory by the OCALL bridge before
+// they are authenticated, so nothing is read twice from untrusted memory.
+template <class P>
+struct StreamUnsealWorkload {
+    static int run(const char* sealed_filename, uint64_t* plain_bytes, uint32_t* checksum) {
+        arena::Scope scope;
+        *plain_bytes = 0;
+        *checksum = 0;
+        P::speculation_barrier();
+
+        StreamHandle input;
+        sealed_stream_header_t header;
+        uint64_t file_size = 0;
+        P::flush_boundary();
+        if (ocall_stream_open_read(&input.handle, sealed_filename,
+                                   reinterpret_cast<uint8_t*>(&header), sizeof(header),
+                                   &file_size) != SGX_SUCCESS || input.handle < 0) {
+            return SEALED_STREAM_IO_ERROR;
+        }
+
+        if (header.magic != SEALED_STREAM_MAGIC || header.version != SEALED_STREAM_VERSION ||
+            header.chunk_size < SEALED_STREAM_MIN_CHUNK || header.chunk_size > SEALED_STREAM_MAX_CHUNK ||
+            header.key_blob_size > SEALED_STREAM_KEY_BLOB_SIZE ||
+            header.chunk_count != chunk_count_for(header.plain_size, header.chunk_size)) {
+            return SEALED_STREAM_BAD_HEADER;
+        }
+        P::speculation_barrier();
+
+        const sgx_sealed_data_t* blob = reinterpret_cast<const sgx_sealed_data_t*>(header.key_blob);
+        uint8_t mac_text[SEALED_STREAM_HEADER_MAC_TEXT_SIZE];
+        uint32_t mac_text_size = sizeof(mac_text);
+        FileKey key;
+        uint32_t key_size = sizeof(key.bytes);
+        if (sgx_get_add_mac_txt_len(blob) != mac_text_size ||
+            sgx_get_encrypt_txt_len(blob) != key_size ||
+            sgx_unseal_data(blob, mac_text, &mac_text_size, key.bytes, &key_size) != SGX_SUCCESS ||
+            memcmp(mac_text, &header, sizeof(mac_text)) != 0) {
+            return SEALED_STREAM_AUTH_FAILED;
+        }
+
+        const uint32_t chunk_size = header.chunk_size;
+        ChunkBuffer record(SEALED_STREAM_MAC_SIZE + static_cast<size_t>(chunk_size));
+        ChunkBuffer plain(chunk_size);
+        uint32_t sum = 0;
+
+        for (uint64_t index = 0; index < header.chunk_count; index++) {
+            P::speculation_barrier();
+
+            uint64_t remaining = header.plain_size - index * chunk_size;
+            uint32_t length = remaining < chunk_size ? static_cast<uint32_t>(remaining) : chunk_size;
+
+            size_t bytes_read = 0;
+            sgx_status_t ret;
+            P::flush_boundary();
+            {
+                TRACE_SPAN(TRACE_PHASE_OCALL);
+                ret = ocall_stream_read(&bytes_read, input.handle, record.data, record.size);
+            }
+            if (ret != SGX_SUCCESS || bytes_read != SEALED_STREAM_MAC_SIZE + static_cast<size_t>(length)) {
+                return SEALED_STREAM_IO_ERROR;
+            }
+
+            uint8_t iv[SEALED_STREAM_IV_SIZE];
+            sealed_stream_chunk_aad_t aad;
+            chunk_iv(index, iv);
+            chunk_aad(header, index, length, &aad);
+
+            {
+                TRACE_SPAN(TRACE_PHASE_UNSEAL);
+                ret = sgx_rijndael128GCM_decrypt(
+                    &key.bytes, record.data + SEALED_STREAM_MAC_SIZE, length, plain.data,
+                    iv, SEALED_STREAM_IV_SIZE,
+                    reinterpret_cast<const uint8_t*>(&aad), sizeof(aad),
+                    reinterpret_cast<const sgx_aes_gcm_128bit_tag_t*>(record.data));
+            }
+            if (ret == SGX_ERROR_MAC_MISMATCH) {
+                return SEALED_STREAM_AUTH_FAILED;
+            }
+            if (ret != SGX_SUCCESS) {
+                return SEALED_STREAM_CRYPTO_ERROR;
+            }
+
+            sum += checksum_chunk<P>(plain.data, length);
+        }
+
+        if (P::constant_time_enabled()) {
+            TRACE_SPAN(TRACE_PHASE_ZERO);
+            P::secure_memzero(plain.data, plain.size);
+        }
+
+        *plain_bytes = header.plain_size;
+        *checksum = sum;
+        return SEALED_STREAM_OK;
+    }
+};
+
+} // namespace
+
+int ecall_stream_seal_file(const char* plain_filename, const char* sealed_filename,
+                           uint32_t chunk_size, uint64_t* plain_bytes, uint32_t* checksum) {
+    TRACE_SPAN(TRACE_ECALL_STREAM_SEAL);
+    return policy_dispatch::run<StreamSealWorkload>(plain_filename, sealed_filename, chunk_size,
+                                                    plain_bytes, checksum);
+}
+
+int ecall_stream_unseal_file(const char* sealed_filename, uint64_t* plain_bytes, uint32_t* checksum) {
+    TRACE_SPAN(TRACE_ECALL_STREAM_UNSEAL);
+    return policy_dispatch::run<StreamUnsealWorkload>(sealed_filename, plain_bytes, checksum);
+}
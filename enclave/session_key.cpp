@@ -0,0 +1,251 @@
+// session_key.cpp - Seal key derived once per session, used for direct AES-GCM reads
+#include "enclave_t.h"
+#include "arena.h"
+#include "mitigations.h"
+#include "policy_dispatch.h"
+#include "session_seal_format.h"
+#include "sgx_spinlock.h"
+#include "sgx_tcrypto.h"
+#include "sgx_trts.h"
+#include "sgx_tseal.h"
+#include "sgx_utils.h"
+#include "trace.h"
+#include <string.h>
+
+namespace {
+
+static_assert(sizeof(sgx_key_request_t) == SESSION_SEAL_KEY_REQUEST_SIZE,
+              "SESSION_SEAL_KEY_REQUEST_SIZE must match sgx_key_request_t");
+
+// The current session key. It only ever lives in enclave memory; rotation
+// overwrites it in place under g_session_lock.
+struct SessionKey {
+    sgx_key_request_t request;
+    sgx_key_128bit_t key;
+    uint32_t generation;
+    bool valid;
+};
+
+SessionKey g_session;
+sgx_spinlock_t g_session_lock = SGX_SPINLOCK_INITIALIZER;
+
+struct KeyCopy {
+    sgx_key_128bit_t bytes;
+
+    ~KeyCopy() { mitigations::raw::volatile_zero(bytes, sizeof(bytes)); }
+};
+
+// Same policy sgx_seal_data uses by default (MRSIGNER, current SVNs), with
+// a fresh random key_id so every rotation yields an unrelated key
+bool derive_new_key(sgx_key_request_t* request, sgx_key_128bit_t* key) {
+    memset(request, 0, sizeof(*request));
+    const sgx_report_t* report = sgx_self_report();
+    request->key_name = SGX_KEYSELECT_SEAL;
+    request->key_policy = SGX_KEYPOLICY_MRSIGNER;
+    request->cpu_svn = report->body.cpu_svn;
+    request->isv_svn = report->body.isv_svn;
+    request->config_svn = report->body.config_svn;
+    request->attribute_mask.flags = TSEAL_DEFAULT_FLAGSMASK;
+    request->attribute_mask.xfrm = 0;
+    request->misc_mask = TSEAL_DEFAULT_MISCMASK;
+
+    return sgx_read_rand(request->key_id.id, sizeof(request->key_id.id)) == SGX_SUCCESS &&
+           sgx_get_key(request, key) == SGX_SUCCESS;
+}
+
+int rotate_session_key(uint32_t* generation) {
+    sgx_key_request_t request;
+    KeyCopy fresh;
+    if (!derive_new_key(&request, &fresh.bytes)) {
+        return SESSION_SEAL_CRYPTO_ERROR;
+    }
+
+    sgx_spin_lock(&g_session_lock);
+    g_session.request = request;
+    memcpy(g_session.key, fresh.bytes, sizeof(g_session.key));
+    g_session.generation++;
+    g_session.valid = true;
+    *generation = g_session.generation;
+    sgx_spin_unlock(&g_session_lock);
+    return SESSION_SEAL_OK;
+}
+
+// Copies the session key, deriving the first one on demand
+int current_session_key(sgx_key_request_t* request, KeyCopy* key, uint32_t* generation) {
+    sgx_spin_lock(&g_session_lock);
+    bool valid = g_session.valid;
+    sgx_spin_unlock(&g_session_lock);
+
+    if (!valid) {
+        uint32_t ignored = 0;
+        int status = rotate_session_key(&ignored);
+        if (status != SESSION_SEAL_OK) return status;
+    }
+
+    sgx_spin_lock(&g_session_lock);
+    if (request) *request = g_session.request;
+    memcpy(key->bytes, g_session.key, sizeof(key->bytes));
+    *generation = g_session.generation;
+    sgx_spin_unlock(&g_session_lock);
+    return SESSION_SEAL_OK;
+}
+
+// Copies the cached key if the file was sealed under it
+bool cached_key_for(const sgx_key_request_t& request, KeyCopy* key) {
+    sgx_spin_lock(&g_session_lock);
+    bool match = g_session.valid &&
+                 memcmp(&g_session.request.key_id, &request.key_id, sizeof(request.key_id)) == 0;
+    if (match) {
+        memcpy(key->bytes, g_session.key, sizeof(key->bytes));
+    }
+    sgx_spin_unlock(&g_session_lock);
+    return match;
+}
+
+// Reads a session-sealed file and decrypts it with sgx_rijndael128GCM_decrypt.
+// CACHED mode uses the key in enclave memory; DERIVE mode runs EGETKEY on
+// the stored key request first, which isolates the key derivation cost.
+template <class P>
+struct SessionUnsealWorkload {
+    static int run(const char* filename, int mode) {
+        arena::Scope scope;
+        P::speculation_barrier();
+
+        const size_t header_size = sizeof(session_sealed_header_t);
+        arena::Buffer file(header_size + SESSION_SEAL_MAX_PAYLOAD);
+        size_t bytes_read = 0;
+        sgx_status_t ret;
+        P::flush_boundary();
+        {
+            TRACE_SPAN(TRACE_PHASE_OCALL);
+            ret = ocall_read_sealed_file(&bytes_read, filename, file.data(), file.size());
+        }
+        if (ret != SGX_SUCCESS || bytes_read < header_size || bytes_read > file.size()) {
+            return SESSION_SEAL_IO_ERROR;
+        }
+
+        session_sealed_header_t header;
+        memcpy(&header, file.data(), header_size);
+        if (header.magic != SESSION_SEAL_MAGIC || header.version != SESSION_SEAL_VERSION ||
+            header.payload_size > SESSION_SEAL_MAX_PAYLOAD ||
+            bytes_read != header_size + header.payload_size) {
+            return SESSION_SEAL_BAD_HEADER;
+        }
+        P::speculation_barrier();
+
+        sgx_key_request_t request;
+        memcpy(&request, header.key_request, sizeof(request));
+        KeyCopy key;
+        {
+            TRACE_SPAN(TRACE_PHASE_KEY);
+            if (mode == SESSION_UNSEAL_DERIVE) {
+                if (sgx_get_key(&request, &key.bytes) != SGX_SUCCESS) {
+                    return SESSION_SEAL_CRYPTO_ERROR;
+                }
+            } else if (!cached_key_for(request, &key)) {
+                return SESSION_SEAL_STALE_KEY;
+            }
+        }
+
+        arena::Buffer plain(header.payload_size);
+        {
+            TRACE_SPAN(TRACE_PHASE_UNSEAL);
+            ret = sgx_rijndael128GCM_decrypt(
+                &key.bytes, file.data() + header_size, header.payload_size, plain.data(),
+                header.iv, SESSION_SEAL_IV_SIZE,
+                reinterpret_cast<const uint8_t*>(&header), SESSION_SEAL_AAD_SIZE,
+                reinterpret_cast<const sgx_aes_gcm_128bit_tag_t*>(header.mac));
+        }
+        if (ret == SGX_ERROR_MAC_MISMATCH) {
+            return SESSION_SEAL_AUTH_FAILED;
+        }
+        if (ret != SGX_SUCCESS) {
+            return SESSION_SEAL_CRYPTO_ERROR;
+        }
+
+        {
+            TRACE_SPAN(TRACE_PHASE_CHECKSUM);
+            volatile uint32_t checksum = 0;
+            for (size_t i = 0; i < header.payload_size; i++) {
+                checksum += plain.data()[P::index_nospec(i, plain.size())];
+                P::loop_barrier(i);
+            }
+        }
+
+        TRACE_SPAN(TRACE_PHASE_ZERO);
+        P::secure_memzero(plain.data(), plain.size());
+        return SESSION_SEAL_OK;
+    }
+};
+
+} // namespace
+
+int ecall_session_key_rotate(uint32_t* generation) {
+    TRACE_SPAN(TRACE_ECALL_SESSION_KEY_ROTATE);
+    *generation = 0;
+    apply_speculation_mitigations();
+    mitigations::FlushScope flushes;
+    TRACE_SPAN(TRACE_PHASE_KEY);
+    return rotate_session_key(generation);
+}
+
+int ecall_session_seal_file(const char* filename, const uint8_t* data, size_t data_len) {
+    TRACE_SPAN(TRACE_ECALL_SESSION_SEAL);
+    apply_speculation_mitigations();
+    mitigations::FlushScope flushes;
+    arena::Scope scope;
+
+    const uint32_t payload_size = data_len > SESSION_SEAL_MAX_PAYLOAD
+                                      ? SESSION_SEAL_MAX_PAYLOAD
+                                      : static_cast<uint32_t>(data_len);
+
+    session_sealed_header_t header;
+    memset(&header, 0, sizeof(header));
+    header.magic = SESSION_SEAL_MAGIC;
+    header.version = SESSION_SEAL_VERSION;
+    header.payload_size = payload_size;
+
+    sgx_key_request_t request;
+    KeyCopy key;
+    int status;
+    {
+        TRACE_SPAN(TRACE_PHASE_KEY);
+        status = current_session_key(&request, &key, &header.generation);
+    }
+    if (status != SESSION_SEAL_OK) return status;
+    memcpy(header.key_request, &request, sizeof(request));
+
+    if (sgx_read_rand(header.iv, sizeof(header.iv)) != SGX_SUCCESS) {
+        return SESSION_SEAL_CRYPTO_ERROR;
+    }
+
+    const size_t header_size = sizeof(header);
+    arena::Buffer file(header_size + payload_size);
+    sgx_status_t ret;
+    {
+        TRACE_SPAN(TRACE_PHASE_SEAL);
+        ret = sgx_rijndael128GCM_encrypt(
+            &key.bytes, data, payload_size, file.data() + header_size,
+            header.iv, SESSION_SEAL_IV_SIZE,
+            reinterpret_cast<const uint8_t*>(&header), SESSION_SEAL_AAD_SIZE,
+            reinterpret_cast<sgx_aes_gcm_128bit_tag_t*>(header.mac));
+    }
+    if (ret != SGX_SUCCESS) {
+        return SESSION_SEAL_CRYPTO_ERROR;
+    }
+    memcpy(file.data(), &header, header_size);
+
+    int write_result = -1;
+    mitigations::raw::flush_drain();
+    TRACE_SPAN(TRACE_PHASE_OCALL);
+    if (ocall_write_sealed_file(&write_result, filename, file.data(), file.size()) != SGX_SUCCESS ||
+        write_result != 0) {
+        return SESSION_SEAL_IO_ERROR;
+    }
+    return SESSION_SEAL_OK;
+}
+
+int ecall_session_unseal_file(const char* filename, int mode) {
+    TRACE_SPAN(TRACE_ECALL_SESSION_UNSEAL);
+    return policy_dispatch::run<SessionUnsealWorkload>(filename, mode);
+}
@@ -0,0 +1,114 @@
+// trace.cpp - Per-TCS trace rings, their export and the trace ECALLs
+#include "trace.h"
+#include "enclave_t.h"
+#include "mitigations.h"
+#include "trusted_timer.h"
+#include "sgx_spinlock.h"
+#include <new>
+
+namespace {
+
+struct Ring {
+    trace_event_t events[TRACE_RING_EVENTS];
+    uint32_t count;
+    uint32_t id;
+};
+
+// Rings are created on a TCS's first event and kept for the life of the
+// enclave; the table lets ecall_trace_drain reach every TCS's ring
+Ring* g_rings[TRACE_MAX_RINGS];
+uint32_t g_ring_count = 0;
+bool g_rings_full = false;
+sgx_spinlock_t g_ring_lock = SGX_SPINLOCK_INITIALIZER;
+
+__thread Ring* t_ring = NULL;
+
+Ring* acquire_ring() {
+    if (g_rings_full) return NULL;
+    Ring* ring = new (std::nothrow) Ring;
+    if (ring == NULL) return NULL;
+    ring->count = 0;
+
+    bool registered = false;
+    sgx_spin_lock(&g_ring_lock);
+    if (g_ring_count < TRACE_MAX_RINGS) {
+        ring->id = g_ring_count;
+        g_rings[g_ring_count++] = ring;
+        registered = true;
+    } else {
+        g_rings_full = true;
+    }
+    sgx_spin_unlock(&g_ring_lock);
+
+    if (!registered) {
+        delete ring;
+        return NULL;
+    }
+    t_ring = ring;
+    return ring;
+}
+
+void append(Ring* ring, uint16_t phase, uint8_t kind, uint64_t tsc) {
+    trace_event_t& event = ring->events[ring->count++];
+    event.tsc = tsc;
+    event.phase = phase;
+    event.kind = kind;
+    event.reserved = 0;
+    event.ring = ring->id;
+}
+
+void export_ring(Ring* ring) {
+    if (ring->count > 0) {
+        // Rings fill mid-workload, so this is a trust boundary like any OCALL
+        mitigations::raw::flush_drain();
+        ocall_trace_export(ring->events, ring->count);
+        ring->count = 0;
+    }
+}
+
+} // namespace
+
+namespace trace {
+
+volatile bool g_enabled = false;
+
+void record(uint16_t phase, uint8_t kind) {
+    Ring* ring = t_ring != NULL ? t_ring : acquire_ring();
+    if (ring == NULL) return;
+
+    if (ring->count == TRACE_RING_EVENTS) {
+        uint64_t begin = trusted_timer::now();
+        export_ring(ring);
+        append(ring, TRACE_PHASE_EXPORT, TRACE_BEGIN, begin);
+        append(ring, TRACE_PHASE_EXPORT, TRACE_END, trusted_timer::now());
+    }
+    append(ring, phase, kind, trusted_timer::now());
+}
+
+} // namespace trace
+
+int ecall_trace_enable(int enabled) {
+#ifdef ENCLAVE_TRACE
+    if (!enabled) {
+        trace::g_enabled = false;
+        return TRACE_STATUS_DISABLED;
+    }
+    trusted_timer::probe();
+    if (!trusted_timer::available()) return TRACE_STATUS_NO_TIMER;
+    trace::g_enabled = true;
+    return TRACE_STATUS_ENABLED;
+#else
+    (void)enabled;
+    return TRACE_STATUS_NOT_BUILT;
+#endif
+}
+
+void ecall_trace_drain() {
+    sgx_spin_lock(&g_ring_lock);
+    uint32_t count = g_ring_count;
+    sgx_spin_unlock(&g_ring_lock);
+
+    for (uint32_t i = 0; i < count; i++) {
+        export_ring(g_rings[i]);
+    }
+}
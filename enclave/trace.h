@@ -0,0 +1,49 @@
+// trace.h - Phase trace points recorded into a per-TCS ring
+#ifndef TRACE_H
+#define TRACE_H
+
+#include "trace_types.h"
+#include <stdint.h>
+
+// TRACE_SPAN(phase) records a TRACE_BEGIN event where it stands and the
+// matching TRACE_END when its block ends. Trace points are compiled in only
+// with -DENCLAVE_TRACE (make TRACE=1); otherwise they are empty statements.
+//
+// When compiled in, nothing is recorded until ecall_trace_enable(1), which
+// also requires the trusted TSC. Each TCS appends (phase, TSC) events to
+// its own ring of TRACE_RING_EVENTS without locking. A full ring is
+// exported through ocall_trace_export from inside the workload, and the
+// export is recorded as a TRACE_PHASE_EXPORT span so its cost shows up in
+// the breakdown. ecall_trace_drain exports what is left in every ring; it
+// must not run concurrently with traced ECALLs.
+namespace trace {
+    extern volatile bool g_enabled;
+
+    void record(uint16_t phase, uint8_t kind);
+
+    class Span {
+    public:
+        explicit Span(uint16_t phase) : phase_(phase) {
+            if (g_enabled) record(phase_, TRACE_BEGIN);
+        }
+        ~Span() {
+            if (g_enabled) record(phase_, TRACE_END);
+        }
+
+    private:
+        Span(const Span&);
+        Span& operator=(const Span&);
+
+        uint16_t phase_;
+    };
+}
+
+#ifdef ENCLAVE_TRACE
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+#define TRACE_SPAN(phase) trace::Span TRACE_CONCAT(trace_span_, __LINE__)(phase)
+#else
+#define TRACE_SPAN(phase) do {} while (0)
+#endif
+
+#endif // TRACE_H
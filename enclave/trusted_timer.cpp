@@ -0,0 +1,38 @@
+// trusted_timer.cpp
+
+#include "trusted_timer.h"
+#include "sgx_trts_exception.h"
+
+namespace trusted_timer {
+    bool g_available = false;
+
+    static volatile bool probe_faulted = false;
+
+    // Skips a faulting RDTSC (0F 31) and records that the probe failed
+    static int rdtsc_fault_handler(sgx_exception_info_t* info) {
+        const uint8_t* ip = reinterpret_cast<const uint8_t*>(info->cpu_context.rip);
+        if (info->exception_vector == SGX_EXCEPTION_VECTOR_UD &&
+            ip[0] == 0x0F && ip[1] == 0x31) {
+            probe_faulted = true;
+            info->cpu_context.rip += 2;
+            return EXCEPTION_CONTINUE_EXECUTION;
+        }
+        return EXCEPTION_CONTINUE_SEARCH;
+    }
+
+    void probe() {
+        if (g_available) return;
+
+        void* handler = sgx_register_exception_handler(1, rdtsc_fault_handler);
+        if (!handler) return;
+
+        probe_faulted = false;
+        uint32_t lo, hi;
+        __asm__ volatile ("rdtsc" : "=a" (lo), "=d" (hi) :: "memory");
+        (void)lo;
+        (void)hi;
+
+        sgx_unregister_exception_handler(handler);
+        g_available = !probe_faulted;
+    }
+}
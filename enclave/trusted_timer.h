@@ -0,0 +1,42 @@
+// trusted_timer.h - TSC reads from inside the enclave
+#ifndef TRUSTED_TIMER_H
+#define TRUSTED_TIMER_H
+
+#include <stdint.h>
+
+// RDTSC only executes inside an enclave on SGX2-capable parts (and in
+// simulation mode); on SGX1 it raises #UD. probe() finds out which case
+// applies by executing it once under a temporary exception handler.
+// Until probe() has succeeded, start()/stop() return 0.
+namespace trusted_timer {
+    extern bool g_available;
+
+    void probe();
+
+    inline bool available() { return g_available; }
+
+    inline uint64_t start() {
+        if (!g_available) return 0;
+        uint32_t lo, hi;
+        __asm__ volatile ("lfence\n\trdtsc\n\tlfence" : "=a" (lo), "=d" (hi) :: "memory");
+        return ((uint64_t)hi << 32) | lo;
+    }
+
+    // Unfenced read for trace timestamps: RDTSCP waits for earlier
+    // instructions to finish but does not hold back later ones
+    inline uint64_t now() {
+        if (!g_available) return 0;
+        uint32_t lo, hi, aux;
+        __asm__ volatile ("rdtscp" : "=a" (lo), "=d" (hi), "=c" (aux) :: "memory");
+        return ((uint64_t)hi << 32) | lo;
+    }
+
+    inline uint64_t stop() {
+        if (!g_available) return 0;
+        uint32_t lo, hi, aux;
+        __asm__ volatile ("rdtscp\n\tlfence" : "=a" (lo), "=d" (hi), "=c" (aux) :: "memory");
+        return ((uint64_t)hi << 32) | lo;
+    }
+}
+
+#endif // TRUSTED_TIMER_H
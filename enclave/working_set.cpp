@@ -0,0 +1,136 @@
+// working_set.cpp - Configurable in-enclave working set for EPC pressure tests
+#include "enclave_t.h"
+#include "policy_dispatch.h"
+#include "trace.h"
+#include "working_set_types.h"
+#include <new>
+
+namespace {
+
+// One cache line; `next` links the lines into a single random cycle for
+// the pointer-chasing pattern
+struct Line {
+    uint64_t next;
+    uint64_t payload[WORKING_SET_LINE_SIZE / sizeof(uint64_t) - 1];
+};
+
+struct WorkingSet {
+    uint8_t* allocation;
+    Line* lines;
+    uint64_t count;
+    uint64_t rng;
+};
+
+WorkingSet g_set = {NULL, NULL, 0, 0};
+
+inline uint64_t next_random(uint64_t& state) {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+// Uniform index in [0, n) without a division
+inline uint64_t random_index(uint64_t& state, uint64_t n) {
+    return static_cast<uint64_t>((static_cast<unsigned __int128>(next_random(state)) * n) >> 64);
+}
+
+template <class P>
+struct WorkingSetWorkload {
+    static int run(int pattern, uint64_t accesses, uint64_t* checksum) {
+        *checksum = 0;
+        if (g_set.lines == NULL) return -1;
+        P::speculation_barrier();
+
+        Line* lines = g_set.lines;
+        const uint64_t count = g_set.count;
+        uint64_t index = 0;
+        uint64_t sum = 0;
+
+        // One span for the whole loop: a span per access would trace
+        // millions of events and distort the access latency itself
+        TRACE_SPAN(TRACE_PHASE_COMPUTE);
+        for (uint64_t i = 0; i < accesses; i++) {
+            switch (pattern) {
+                case WORKING_SET_SEQUENTIAL:
+                    index = (index + 1 == count) ? 0 : index + 1;
+                    sum += lines[index].next;
+                    break;
+                case WORKING_SET_RANDOM:
+                    index = random_index(g_set.rng, count);
+                    sum += lines[index].next;
+                    break;
+                default:
+                    index = P::index_nospec(lines[index].next, count);
+                    sum += index;
+                    break;
+            }
+            // Flushing every touched line is what turns EPC hits into
+            // memory-encryption-engine round trips
+            if (P::cache_enabled()) {
+                P::cache_flush(&lines[index], sizeof(Line));
+            }
+            P::loop_barrier(i);
+        }
+
+        if (P::memory_enabled()) {
+            P::memory_barrier();
+        }
+        *checksum = sum;
+        return 0;
+    }
+};
+
+} // namespace
+
+void ecall_working_set_release() {
+    delete[] g_set.allocation;
+    g_set.allocation = NULL;
+    g_set.lines = NULL;
+    g_set.count = 0;
+}
+
+// Allocates and initialises `bytes` of cache-line-sized entries, which
+// touches every page once. The pointer-chase links form a single random
+// cycle (Sattolo's algorithm), so a chase visits every line.
+int ecall_working_set_prepare(size_t bytes, uint64_t seed) {
+    TRACE_SPAN(TRACE_ECALL_WORKING_SET_PREPARE);
+    ecall_working_set_release();
+
+    uint64_t count = bytes / sizeof(Line);
+    if (count < 2) return -1;
+
+    uint8_t* allocation = new (std::nothrow) uint8_t[count * sizeof(Line) + WORKING_SET_LINE_SIZE];
+    if (allocation == NULL) return -1;
+
+    uintptr_t aligned = (reinterpret_cast<uintptr_t>(allocation) + WORKING_SET_LINE_SIZE - 1) &
+                        ~static_cast<uintptr_t>(WORKING_SET_LINE_SIZE - 1);
+    Line* lines = reinterpret_cast<Line*>(aligned);
+
+    for (uint64_t i = 0; i < count; i++) {
+        lines[i].next = i;
+        for (size_t k = 0; k < sizeof(lines[i].payload) / sizeof(uint64_t); k++) {
+            lines[i].payload[k] = i ^ k;
+        }
+    }
+
+    uint64_t rng = seed ? seed : 0x2545F4914F6CDD1DULL;
+    for (uint64_t i = count - 1; i > 0; i--) {
+        uint64_t j = random_index(rng, i);
+        uint64_t tmp = lines[i].next;
+        lines[i].next = lines[j].next;
+        lines[j].next = tmp;
+    }
+
+    g_set.allocation = allocation;
+    g_set.lines = lines;
+    g_set.count = count;
+    g_set.rng = rng;
+    return 0;
+}
+
+int ecall_working_set_touch(int pattern, uint64_t accesses, uint64_t* checksum) {
+    TRACE_SPAN(TRACE_ECALL_WORKING_SET_TOUCH);
+    if (pattern < 0 || pattern >= WORKING_SET_PATTERN_COUNT) return -1;
+    return policy_dispatch::run<WorkingSetWorkload>(pattern, accesses, checksum);
+}
@@ -0,0 +1,158 @@
+#!/usr/bin/env python3
+# native/edl_native.py - Edge routines for the native (non-enclave) backend
+#
+# Reads enclave.edl and writes, into OUTDIR:
+#   enclave_u.h        what the app sees: ECALL proxies taking an enclave id,
+#                      and the OCALL handlers it implements
+#   enclave_t.h        what the enclave sources see: their ECALLs and the
+#                      OCALL proxies, renamed so both sides link into one
+#                      binary
+#   enclave_native.cpp the bridge between the two: plain function calls, no
+#                      marshalling and no transition
+#
+# Buffer attributes ([in], [out], size=...) are parsed away: the native
+# backend passes every pointer straight through, which is the point of it.
+# Imported system EDLs (sgx_tstdc, sgx_tswitchless) are not needed natively.
+#
+# usage: edl_native.py ENCLAVE_EDL OUTDIR
+
+import os
+import re
+import sys
+
+TRUSTED_PREFIX = "native_trusted_"
+OCALL_PREFIX = "native_ocall_"
+
+
+def strip_comments(text):
+    text = re.sub(r"/\*.*?\*/", "", text, flags=re.S)
+    return re.sub(r"//[^\n]*", "", text)
+
+
+def section(text, name):
+    match = re.search(r"\b" + name + r"\s*\{(.*?)\}\s*;", text, re.S)
+    if not match:
+        sys.exit("edl_native: no '%s' section" % name)
+    return match.group(1)
+
+
+def parse_params(params):
+    params = re.sub(r"\[[^\]]*\]", "", params).strip()
+    if params in ("", "void"):
+        return []
+    parsed = []
+    for param in params.split(","):
+        param = " ".join(param.split())
+        match = re.match(r"^(.*?)(\w+)$", param)
+        if not match or not match.group(1).strip():
+            sys.exit("edl_native: cannot parse parameter '%s'" % param)
+        parsed.append((match.group(1).strip(), match.group(2)))
+    return parsed
+
+
+def parse_functions(body):
+    functions = []
+    for decl in body.split(";"):
+        decl = " ".join(decl.split())
+        if "(" not in decl:
+            continue
+        decl = re.sub(r"\b(public|transition_using_threads|propagate_errno)\b", "", decl)
+        decl = re.sub(r"\ballow\s*\([^)]*\)", "", decl)
+        match = re.match(r"^\s*(.*?)\s*(\w+)\s*\((.*)\)\s*$", decl)
+        if not match:
+            sys.exit("edl_native: cannot parse declaration '%s'" % decl)
+        functions.append((match.group(1).strip(), match.group(2), parse_params(match.group(3))))
+    return functions
+
+
+def param_list(params):
+    return ", ".join("%s %s" % (ptype, pname) for ptype, pname in params)
+
+
+def proxy_params(ret, params, with_eid):
+    args = []
+    if with_eid:
+        args.append("sgx_enclave_id_t eid")
+    if ret != "void":
+        args.append("%s* retval" % ret)
+    args.extend("%s %s" % (ptype, pname) for ptype, pname in params)
+    return ", ".join(args)
+
+
+def call(name, params):
+    return "%s(%s)" % (name, ", ".join(pname for _, pname in params))
+
+
+def forward(ret, target, params):
+    if ret == "void":
+        return "    %s;\n" % call(target, params)
+    return ("    %s result = %s;\n"
+            "    if (retval) *retval = result;\n" % (ret, call(target, params)))
+
+
+def header(guard, includes, body):
+    lines = ["// Generated by native/edl_native.py from enclave.edl; do not edit",
+             "#ifndef %s" % guard, "#define %s" % guard, "",
+             "#include <stddef.h>", "#include <stdint.h>", '#include "sgx_edger8r.h"']
+    lines += ['#include "%s"' % include for include in includes]
+    lines += ["", "#ifdef __cplusplus", 'extern "C" {', "#endif", ""]
+    lines += body
+    lines += ["", "#ifdef __cplusplus", "}", "#endif", "", "#endif // %s" % guard, ""]
+    return "\n".join(lines)
+
+
+def main():
+    if len(sys.argv) != 3:
+        sys.exit("usage: edl_native.py ENCLAVE_EDL OUTDIR")
+    text = strip_comments(open(sys.argv[1]).read())
+    includes = re.findall(r'\binclude\s+"([^"]+)"', text)
+    trusted = parse_functions(section(text, "trusted"))
+    untrusted = parse_functions(section(text, "untrusted"))
+    outdir = sys.argv[2]
+    os.makedirs(outdir, exist_ok=True)
+
+    body = ["// OCALL handlers, implemented by the app"]
+    body += ["%s %s(%s);" % (ret, name, param_list(params)) for ret, name, params in untrusted]
+    body += ["", "// ECALL proxies"]
+    body += ["sgx_status_t %s(%s);" % (name, proxy_params(ret, params, True))
+             for ret, name, params in trusted]
+    with open(os.path.join(outdir, "enclave_u.h"), "w") as out:
+        out.write(header("ENCLAVE_U_H", includes, body))
+
+    body = ["// ECALLs and OCALL proxies share names with the app side, so the",
+            "// enclave sources see them under native-only names"]
+    body += ["#define %s %s%s" % (name, TRUSTED_PREFIX, name) for _, name, _ in trusted]
+    body += ["#define %s %s%s" % (name, OCALL_PREFIX, name) for _, name, _ in untrusted]
+    body += ["", "// ECALLs, implemented by the enclave sources"]
+    body += ["%s %s(%s);" % (ret, name, param_list(params)) for ret, name, params in trusted]
+    body += ["", "// OCALL proxies"]
+    body += ["sgx_status_t %s(%s);" % (name, proxy_params(ret, params, False))
+             for ret, name, params in untrusted]
+    with open(os.path.join(outdir, "enclave_t.h"), "w") as out:
+        out.write(header("ENCLAVE_T_H", includes, body))
+
+    lines = ["// Generated by native/edl_native.py from enclave.edl; do not edit",
+             "// ECALLs and OCALLs as direct calls between the app and the enclave sources",
+             "#include <stddef.h>", "#include <stdint.h>", '#include "sgx_edger8r.h"']
+    lines += ['#include "%s"' % include for include in includes]
+    lines += ["", 'extern "C" {', ""]
+    lines += ["%s %s%s(%s);" % (ret, TRUSTED_PREFIX, name, param_list(params))
+              for ret, name, params in trusted]
+    lines += ["%s %s(%s);" % (ret, name, param_list(params)) for ret, name, params in untrusted]
+    lines.append("")
+    for ret, name, params in trusted:
+        lines.append("sgx_status_t %s(%s) {" % (name, proxy_params(ret, params, True)))
+        lines.append("    (void)eid;")
+        lines.append(forward(ret, TRUSTED_PREFIX + name, params).rstrip("\n"))
+        lines += ["    return SGX_SUCCESS;", "}", ""]
+    for ret, name, params in untrusted:
+        lines.append("sgx_status_t %s%s(%s) {" % (OCALL_PREFIX, name, proxy_params(ret, params, False)))
+        lines.append(forward(ret, name, params).rstrip("\n"))
+        lines += ["    return SGX_SUCCESS;", "}", ""]
+    lines += ['} // extern "C"', ""]
+    with open(os.path.join(outdir, "enclave_native.cpp"), "w") as out:
+        out.write("\n".join(lines))
+
+
+if __name__ == "__main__":
+    main()
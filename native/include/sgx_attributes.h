@@ -0,0 +1,20 @@
+// sgx_attributes.h - Native backend stand-in for the SGX SDK header
+#ifndef SGX_ATTRIBUTES_H
+#define SGX_ATTRIBUTES_H
+
+#include <stdint.h>
+
+#define SGX_FLAGS_INITTED    0x0000000000000001ULL
+#define SGX_FLAGS_DEBUG      0x0000000000000002ULL
+#define SGX_FLAGS_MODE64BIT  0x0000000000000004ULL
+#define SGX_FLAGS_PROVISION_KEY 0x0000000000000010ULL
+#define SGX_FLAGS_EINITTOKEN_KEY 0x0000000000000020ULL
+
+typedef struct _attributes_t {
+    uint64_t flags;
+    uint64_t xfrm;
+} sgx_attributes_t;
+
+typedef uint32_t sgx_misc_select_t;
+
+#endif // SGX_ATTRIBUTES_H
@@ -0,0 +1,19 @@
+// sgx_cpuid.h - Native backend stand-in for the SGX SDK header
+#ifndef SGX_CPUID_H
+#define SGX_CPUID_H
+
+#include "sgx_error.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Executes CPUID directly; there is no OCALL to leave the enclave for it
+sgx_status_t sgx_cpuid(int cpuinfo[4], int leaf);
+sgx_status_t sgx_cpuidex(int cpuinfo[4], int leaf, int subleaf);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SGX_CPUID_H
@@ -0,0 +1,10 @@
+// sgx_edger8r.h - Native backend stand-in for the SGX SDK header
+#ifndef SGX_EDGER8R_H
+#define SGX_EDGER8R_H
+
+#include "sgx_eid.h"
+#include "sgx_error.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#endif // SGX_EDGER8R_H
@@ -0,0 +1,9 @@
+// sgx_eid.h - Native backend stand-in for the SGX SDK header
+#ifndef SGX_EID_H
+#define SGX_EID_H
+
+#include <stdint.h>
+
+typedef uint64_t sgx_enclave_id_t;
+
+#endif // SGX_EID_H
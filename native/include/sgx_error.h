@@ -0,0 +1,20 @@
+// sgx_error.h - Native backend stand-in for the SGX SDK header
+#ifndef SGX_ERROR_H
+#define SGX_ERROR_H
+
+// Same values as the SDK, so status codes print the same on every backend
+typedef enum _status_t {
+    SGX_SUCCESS                     = 0x0000,
+    SGX_ERROR_UNEXPECTED            = 0x0001,
+    SGX_ERROR_INVALID_PARAMETER     = 0x0002,
+    SGX_ERROR_OUT_OF_MEMORY         = 0x0003,
+    SGX_ERROR_ENCLAVE_LOST          = 0x0004,
+    SGX_ERROR_INVALID_STATE         = 0x0005,
+    SGX_ERROR_FEATURE_NOT_SUPPORTED = 0x0008,
+    SGX_ERROR_INVALID_ENCLAVE_ID    = 0x2002,
+    SGX_ERROR_OUT_OF_TCS            = 0x1003,
+    SGX_ERROR_MAC_MISMATCH          = 0x3001,
+    SGX_ERROR_INVALID_KEYNAME       = 0x4003
+} sgx_status_t;
+
+#endif // SGX_ERROR_H
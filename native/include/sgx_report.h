@@ -0,0 +1,46 @@
+// sgx_report.h - Native backend stand-in for the SGX SDK header
+#ifndef SGX_REPORT_H
+#define SGX_REPORT_H
+
+#include "sgx_attributes.h"
+#include "sgx_key.h"
+#include <stdint.h>
+
+typedef struct _sgx_measurement_t {
+    uint8_t m[32];
+} sgx_measurement_t;
+
+typedef uint16_t sgx_prod_id_t;
+
+typedef struct _report_data_t {
+    uint8_t d[64];
+} sgx_report_data_t;
+
+// Same layout as the SDK; natively only cpu_svn and attributes (flags, and
+// xfrm from XGETBV) carry meaning, everything else is zero
+typedef struct _report_body_t {
+    sgx_cpu_svn_t     cpu_svn;
+    sgx_misc_select_t misc_select;
+    uint8_t           reserved1[12];
+    uint8_t           isv_ext_prod_id[16];
+    sgx_attributes_t  attributes;
+    sgx_measurement_t mr_enclave;
+    uint8_t           reserved2[32];
+    sgx_measurement_t mr_signer;
+    uint8_t           reserved3[32];
+    uint8_t           config_id[64];
+    sgx_prod_id_t     isv_prod_id;
+    sgx_isv_svn_t     isv_svn;
+    sgx_config_svn_t  config_svn;
+    uint8_t           reserved4[42];
+    uint8_t           isv_family_id[16];
+    sgx_report_data_t report_data;
+} sgx_report_body_t;
+
+typedef struct _report_t {
+    sgx_report_body_t body;
+    sgx_key_id_t      key_id;
+    uint8_t           mac[16];
+} sgx_report_t;
+
+#endif // SGX_REPORT_H
@@ -0,0 +1,22 @@
+// sgx_spinlock.h - Native backend stand-in for the SGX SDK header
+#ifndef SGX_SPINLOCK_H
+#define SGX_SPINLOCK_H
+
+#include <stdint.h>
+
+typedef volatile uint32_t sgx_spinlock_t;
+
+#define SGX_SPINLOCK_INITIALIZER 0
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+uint32_t sgx_spin_lock(sgx_spinlock_t* lock);
+uint32_t sgx_spin_unlock(sgx_spinlock_t* lock);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SGX_SPINLOCK_H
@@ -0,0 +1,73 @@
+// sgx_tcrypto.h - Native backend stand-in for the SGX SDK header
+#ifndef SGX_TCRYPTO_H
+#define SGX_TCRYPTO_H
+
+#include "sgx_error.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#define SGX_SHA256_HASH_SIZE     32
+#define SGX_ECP256_KEY_SIZE      32
+#define SGX_NISTP_ECP256_KEY_SIZE (SGX_ECP256_KEY_SIZE / sizeof(uint32_t))
+#define SGX_AESGCM_IV_SIZE       12
+#define SGX_AESGCM_KEY_SIZE      16
+#define SGX_AESGCM_MAC_SIZE      16
+#define SGX_HMAC256_KEY_SIZE     32
+#define SGX_HMAC256_MAC_SIZE     32
+
+typedef uint8_t sgx_sha256_hash_t[SGX_SHA256_HASH_SIZE];
+typedef uint8_t sgx_aes_gcm_128bit_key_t[SGX_AESGCM_KEY_SIZE];
+typedef uint8_t sgx_aes_gcm_128bit_tag_t[SGX_AESGCM_MAC_SIZE];
+typedef void* sgx_ecc_state_handle_t;
+
+typedef struct _sgx_ec256_private_t {
+    uint8_t r[SGX_ECP256_KEY_SIZE];
+} sgx_ec256_private_t;
+
+typedef struct _sgx_ec256_public_t {
+    uint8_t gx[SGX_ECP256_KEY_SIZE];
+    uint8_t gy[SGX_ECP256_KEY_SIZE];
+} sgx_ec256_public_t;
+
+typedef struct _sgx_ec256_signature_t {
+    uint32_t x[SGX_NISTP_ECP256_KEY_SIZE];
+    uint32_t y[SGX_NISTP_ECP256_KEY_SIZE];
+} sgx_ec256_signature_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Backed by OpenSSL libcrypto; byte orders follow the SDK (little-endian
+// EC coordinates and signature words)
+sgx_status_t sgx_sha256_msg(const uint8_t* p_src, uint32_t src_len, sgx_sha256_hash_t* p_hash);
+
+sgx_status_t sgx_rijndael128GCM_encrypt(const sgx_aes_gcm_128bit_key_t* p_key,
+                                        const uint8_t* p_src, uint32_t src_len, uint8_t* p_dst,
+                                        const uint8_t* p_iv, uint32_t iv_len,
+                                        const uint8_t* p_aad, uint32_t aad_len,
+                                        sgx_aes_gcm_128bit_tag_t* p_out_mac);
+sgx_status_t sgx_rijndael128GCM_decrypt(const sgx_aes_gcm_128bit_key_t* p_key,
+                                        const uint8_t* p_src, uint32_t src_len, uint8_t* p_dst,
+                                        const uint8_t* p_iv, uint32_t iv_len,
+                                        const uint8_t* p_aad, uint32_t aad_len,
+                                        const sgx_aes_gcm_128bit_tag_t* p_in_mac);
+
+sgx_status_t sgx_hmac_sha256_msg(const unsigned char* p_src, int src_len,
+                                 const unsigned char* p_key, int key_len,
+                                 unsigned char* p_mac, int mac_len);
+
+sgx_status_t sgx_ecc256_open_context(sgx_ecc_state_handle_t* p_ecc_handle);
+sgx_status_t sgx_ecc256_close_context(sgx_ecc_state_handle_t ecc_handle);
+sgx_status_t sgx_ecc256_create_key_pair(sgx_ec256_private_t* p_private, sgx_ec256_public_t* p_public,
+                                        sgx_ecc_state_handle_t ecc_handle);
+sgx_status_t sgx_ecdsa_sign(const uint8_t* p_data, uint32_t data_size,
+                            const sgx_ec256_private_t* p_private,
+                            sgx_ec256_signature_t* p_signature,
+                            sgx_ecc_state_handle_t ecc_handle);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SGX_TCRYPTO_H
@@ -0,0 +1,23 @@
+// sgx_trts.h - Native backend stand-in for the SGX SDK header
+#ifndef SGX_TRTS_H
+#define SGX_TRTS_H
+
+#include "sgx_error.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+sgx_status_t sgx_read_rand(unsigned char* rand, size_t length_in_bytes);
+
+// There is no enclave boundary natively: every buffer is on both sides
+int sgx_is_within_enclave(const void* addr, size_t size);
+int sgx_is_outside_enclave(const void* addr, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SGX_TRTS_H
@@ -0,0 +1,57 @@
+// sgx_trts_exception.h - Native backend stand-in for the SGX SDK header
+#ifndef SGX_TRTS_EXCEPTION_H
+#define SGX_TRTS_EXCEPTION_H
+
+#include <stdint.h>
+
+#define EXCEPTION_CONTINUE_SEARCH    0
+#define EXCEPTION_CONTINUE_EXECUTION -1
+
+typedef enum _sgx_exception_vector_t {
+    SGX_EXCEPTION_VECTOR_DE = 0,
+    SGX_EXCEPTION_VECTOR_DB = 1,
+    SGX_EXCEPTION_VECTOR_BP = 3,
+    SGX_EXCEPTION_VECTOR_BR = 5,
+    SGX_EXCEPTION_VECTOR_UD = 6,
+    SGX_EXCEPTION_VECTOR_GP = 13,
+    SGX_EXCEPTION_VECTOR_PF = 14,
+    SGX_EXCEPTION_VECTOR_MF = 16,
+    SGX_EXCEPTION_VECTOR_AC = 17,
+    SGX_EXCEPTION_VECTOR_XM = 19
+} sgx_exception_vector_t;
+
+typedef enum _sgx_exception_type_t {
+    SGX_EXCEPTION_HARDWARE = 3,
+    SGX_EXCEPTION_SOFTWARE = 6
+} sgx_exception_type_t;
+
+typedef struct _cpu_context_t {
+    uint64_t rax, rcx, rdx, rbx, rsp, rbp, rsi, rdi;
+    uint64_t r8, r9, r10, r11, r12, r13, r14, r15;
+    uint64_t rflags;
+    uint64_t rip;
+} sgx_cpu_context_t;
+
+typedef struct _exception_info_t {
+    sgx_cpu_context_t      cpu_context;
+    sgx_exception_vector_t exception_vector;
+    sgx_exception_type_t   exception_type;
+} sgx_exception_info_t;
+
+typedef int (*sgx_exception_handler_t)(sgx_exception_info_t* info);
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Natively nothing faults into a handler (RDTSC is always allowed), so the
+// handle returned is only a token for sgx_unregister_exception_handler
+void* sgx_register_exception_handler(int is_first_handler,
+                                     sgx_exception_handler_t exception_handler);
+int sgx_unregister_exception_handler(void* handler);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SGX_TRTS_EXCEPTION_H
@@ -0,0 +1,49 @@
+// sgx_tseal.h - Native backend stand-in for the SGX SDK header
+#ifndef SGX_TSEAL_H
+#define SGX_TSEAL_H
+
+#include "sgx_error.h"
+#include "sgx_key.h"
+#include "sgx_tcrypto.h"
+#include <stdint.h>
+
+#define TSEAL_DEFAULT_FLAGSMASK (~(SGX_FLAGS_MODE64BIT | SGX_FLAGS_PROVISION_KEY | SGX_FLAGS_EINITTOKEN_KEY))
+#define TSEAL_DEFAULT_MISCMASK  (~0xF0000000u)
+
+// Same layout as the SDK, so sealed files have the same size on every backend
+typedef struct _aes_gcm_data_t {
+    uint32_t payload_size;
+    uint8_t  reserved[12];
+    uint8_t  payload_tag[SGX_AESGCM_MAC_SIZE];
+    uint8_t  payload[];
+} sgx_aes_gcm_data_t;
+
+typedef struct _sealed_data_t {
+    sgx_key_request_t  key_request;
+    uint32_t           plain_text_offset;
+    uint8_t            reserved[12];
+    sgx_aes_gcm_data_t aes_data;
+} sgx_sealed_data_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+uint32_t sgx_calc_sealed_data_size(const uint32_t add_mac_txt_size, const uint32_t txt_encrypt_size);
+uint32_t sgx_get_add_mac_txt_len(const sgx_sealed_data_t* p_sealed_data);
+uint32_t sgx_get_encrypt_txt_len(const sgx_sealed_data_t* p_sealed_data);
+
+// AES-128-GCM under an MRSIGNER seal key from sgx_get_key
+sgx_status_t sgx_seal_data(const uint32_t additional_MACtext_length,
+                           const uint8_t* p_additional_MACtext,
+                           const uint32_t text2encrypt_length, const uint8_t* p_text2encrypt,
+                           const uint32_t sealed_data_size, sgx_sealed_data_t* p_sealed_data);
+sgx_status_t sgx_unseal_data(const sgx_sealed_data_t* p_sealed_data,
+                             uint8_t* p_additional_MACtext, uint32_t* p_additional_MACtext_length,
+                             uint8_t* p_decrypted_text, uint32_t* p_decrypted_text_length);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SGX_TSEAL_H
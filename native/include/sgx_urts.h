@@ -0,0 +1,34 @@
+// sgx_urts.h - Native backend stand-in for the SGX SDK header
+#ifndef SGX_URTS_H
+#define SGX_URTS_H
+
+#include "sgx_eid.h"
+#include "sgx_error.h"
+#include <stdint.h>
+
+typedef uint8_t sgx_launch_token_t[1024];
+
+typedef struct _sgx_misc_attribute_t {
+    uint64_t flags;
+    uint64_t xfrm;
+    uint32_t misc_select;
+} sgx_misc_attribute_t;
+
+#define SGX_DEBUG_FLAG 1
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Hands out a fresh enclave id without loading the image: the enclave code
+// is already linked into the process
+sgx_status_t sgx_create_enclave(const char* file_name, const int debug,
+                                sgx_launch_token_t* launch_token, int* launch_token_updated,
+                                sgx_enclave_id_t* enclave_id, sgx_misc_attribute_t* misc_attr);
+sgx_status_t sgx_destroy_enclave(const sgx_enclave_id_t enclave_id);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SGX_URTS_H
@@ -0,0 +1,42 @@
+// sgx_uswitchless.h - Native backend stand-in for the SGX SDK header
+#ifndef SGX_USWITCHLESS_H
+#define SGX_USWITCHLESS_H
+
+#include "sgx_urts.h"
+#include <stdint.h>
+
+typedef void (*sgx_uswitchless_worker_callback_t)(int type, int event,
+                                                  const void* stats);
+
+typedef struct {
+    uint32_t switchless_calls_pool_size_qw;
+    uint32_t num_uworkers;
+    uint32_t num_tworkers;
+    uint32_t retries_before_fallback;
+    uint32_t retries_before_sleep;
+    sgx_uswitchless_worker_callback_t callback_func[4];
+} sgx_uswitchless_config_t;
+
+#define SGX_USWITCHLESS_CONFIG_INITIALIZER {0, 1, 1, 20000, 20000, {0, 0, 0, 0}}
+
+#define SGX_CREATE_ENCLAVE_EX_PCL_BIT_IDX        0
+#define SGX_CREATE_ENCLAVE_EX_SWITCHLESS_BIT_IDX 1
+#define SGX_CREATE_ENCLAVE_EX_PCL                (1 << SGX_CREATE_ENCLAVE_EX_PCL_BIT_IDX)
+#define SGX_CREATE_ENCLAVE_EX_SWITCHLESS         (1 << SGX_CREATE_ENCLAVE_EX_SWITCHLESS_BIT_IDX)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// As sgx_create_enclave; the switchless config is accepted and ignored,
+// since every call is already a plain function call
+sgx_status_t sgx_create_enclave_ex(const char* file_name, const int debug,
+                                   sgx_launch_token_t* launch_token, int* launch_token_updated,
+                                   sgx_enclave_id_t* enclave_id, sgx_misc_attribute_t* misc_attr,
+                                   const uint32_t ex_features, const void* ex_features_p[32]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SGX_USWITCHLESS_H
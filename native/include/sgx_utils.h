@@ -0,0 +1,22 @@
+// sgx_utils.h - Native backend stand-in for the SGX SDK header
+#ifndef SGX_UTILS_H
+#define SGX_UTILS_H
+
+#include "sgx_error.h"
+#include "sgx_key.h"
+#include "sgx_report.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Derives a key deterministically from the request fields. The root is a
+// constant in the binary: native keys are for benchmarking, not secrecy.
+sgx_status_t sgx_get_key(const sgx_key_request_t* key_request, sgx_key_128bit_t* key);
+const sgx_report_t* sgx_self_report(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SGX_UTILS_H
@@ -0,0 +1,464 @@
+// sgx_native.cpp - SGX SDK services for the native (non-enclave) backend
+//
+// Just enough of the trusted and untrusted runtimes for the enclave sources
+// to run as ordinary host code: crypto and sealing over OpenSSL libcrypto,
+// CPUID/XGETBV for the self report, and enclave ids that name nothing.
+// Results are comparable with the SGX backends in shape and cost, not in
+// security: there is no EPC, no transition and no hardware key.
+
+#define OPENSSL_SUPPRESS_DEPRECATED
+
+#include "sgx_cpuid.h"
+#include "sgx_spinlock.h"
+#include "sgx_tcrypto.h"
+#include "sgx_trts.h"
+#include "sgx_trts_exception.h"
+#include "sgx_tseal.h"
+#include "sgx_urts.h"
+#include "sgx_uswitchless.h"
+#include "sgx_utils.h"
+
+#include <cpuid.h>
+#include <limits.h>
+#include <string.h>
+
+#include <openssl/bn.h>
+#include <openssl/ec.h>
+#include <openssl/ecdsa.h>
+#include <openssl/evp.h>
+#include <openssl/hmac.h>
+#include <openssl/obj_mac.h>
+#include <openssl/rand.h>
+#include <openssl/sha.h>
+
+namespace {
+    // Root of every native key derivation; public by design
+    const uint8_t kNativeRootKey[32] = {
+        's', 'g', 'x', '-', 'b', 'e', 'n', 'c', 'h', 'm', 'a', 'r', 'k', '-', 'n', 'a',
+        't', 'i', 'v', 'e', '-', 'r', 'o', 'o', 't', '-', 'k', 'e', 'y', '-', 'v', '1'
+    };
+
+    const uint8_t kSealIv[SGX_AESGCM_IV_SIZE] = {0};
+
+    uint64_t next_enclave_id = 1;
+    sgx_spinlock_t enclave_id_lock = SGX_SPINLOCK_INITIALIZER;
+
+    int exception_handler_token;
+
+    uint64_t read_xcr0() {
+        unsigned int eax, ebx, ecx, edx;
+        if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx) || !(ecx & bit_OSXSAVE)) {
+            return 0x3; // x87 and SSE, always enabled in long mode
+        }
+        uint32_t lo, hi;
+        __asm__ volatile ("xgetbv" : "=a" (lo), "=d" (hi) : "c" (0));
+        return (static_cast<uint64_t>(hi) << 32) | lo;
+    }
+
+    sgx_report_t build_self_report() {
+        sgx_report_t report;
+        memset(&report, 0, sizeof(report));
+        report.body.attributes.flags = SGX_FLAGS_INITTED | SGX_FLAGS_DEBUG | SGX_FLAGS_MODE64BIT;
+        report.body.attributes.xfrm = read_xcr0();
+        return report;
+    }
+
+    // Writes the big-endian magnitude of bn as len little-endian bytes
+    bool bn_to_le(const BIGNUM* bn, uint8_t* out, int len) {
+        return BN_bn2lebinpad(bn, out, len) == len;
+    }
+
+    sgx_status_t gcm(bool encrypt, const sgx_aes_gcm_128bit_key_t* key,
+                     const uint8_t* src, uint32_t src_len, uint8_t* dst,
+                     const uint8_t* iv, uint32_t iv_len,
+                     const uint8_t* aad, uint32_t aad_len, uint8_t* tag) {
+        if (!key || !iv || iv_len != SGX_AESGCM_IV_SIZE || !tag ||
+            (src_len > 0 && (!src || !dst)) || (aad_len > 0 && !aad) ||
+            src_len > INT_MAX || aad_len > INT_MAX) {
+            return SGX_ERROR_INVALID_PARAMETER;
+        }
+
+        EVP_CIPHER_CTX* ctx = EVP_CIPHER_CTX_new();
+        if (!ctx) return SGX_ERROR_OUT_OF_MEMORY;
+
+        sgx_status_t status = SGX_ERROR_UNEXPECTED;
+        int len = 0;
+        int ok = encrypt
+            ? EVP_EncryptInit_ex(ctx, EVP_aes_128_gcm(), NULL, *key, iv)
+            : EVP_DecryptInit_ex(ctx, EVP_aes_128_gcm(), NULL, *key, iv);
+        if (ok && aad_len > 0) {
+            ok = encrypt ? EVP_EncryptUpdate(ctx, NULL, &len, aad, static_cast<int>(aad_len))
+                         : EVP_DecryptUpdate(ctx, NULL, &len, aad, static_cast<int>(aad_len));
+        }
+        if (ok && src_len > 0) {
+            ok = encrypt ? EVP_EncryptUpdate(ctx, dst, &len, src, static_cast<int>(src_len))
+                         : EVP_DecryptUpdate(ctx, dst, &len, src, static_cast<int>(src_len));
+        }
+        if (ok) {
+            if (encrypt) {
+                if (EVP_EncryptFinal_ex(ctx, dst, &len) == 1 &&
+                    EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_GET_TAG, SGX_AESGCM_MAC_SIZE, tag) == 1) {
+                    status = SGX_SUCCESS;
+                }
+            } else if (EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_SET_TAG, SGX_AESGCM_MAC_SIZE, tag) == 1) {
+                status = EVP_DecryptFinal_ex(ctx, dst, &len) == 1 ? SGX_SUCCESS
+                                                                  : SGX_ERROR_MAC_MISMATCH;
+            }
+        }
+
+        EVP_CIPHER_CTX_free(ctx);
+        if (status == SGX_ERROR_MAC_MISMATCH && src_len > 0) {
+            memset(dst, 0, src_len);
+        }
+        return status;
+    }
+}
+
+extern "C" {
+
+// ---------------------------------------------------------------------------
+// Untrusted runtime
+
+sgx_status_t sgx_create_enclave(const char* file_name, const int debug,
+                                sgx_launch_token_t* launch_token, int* launch_token_updated,
+                                sgx_enclave_id_t* enclave_id, sgx_misc_attribute_t* misc_attr) {
+    (void)debug;
+    (void)launch_token;
+    if (!file_name || !enclave_id) return SGX_ERROR_INVALID_PARAMETER;
+
+    sgx_spin_lock(&enclave_id_lock);
+    *enclave_id = next_enclave_id++;
+    sgx_spin_unlock(&enclave_id_lock);
+
+    if (launch_token_updated) *launch_token_updated = 0;
+    if (misc_attr) {
+        const sgx_report_t* report = sgx_self_report();
+        misc_attr->flags = report->body.attributes.flags;
+        misc_attr->xfrm = report->body.attributes.xfrm;
+        misc_attr->misc_select = 0;
+    }
+    return SGX_SUCCESS;
+}
+
+sgx_status_t sgx_create_enclave_ex(const char* file_name, const int debug,
+                                   sgx_launch_token_t* launch_token, int* launch_token_updated,
+                                   sgx_enclave_id_t* enclave_id, sgx_misc_attribute_t* misc_attr,
+                                   const uint32_t ex_features, const void* ex_features_p[32]) {
+    if ((ex_features & SGX_CREATE_ENCLAVE_EX_SWITCHLESS) &&
+        (!ex_features_p || !ex_features_p[SGX_CREATE_ENCLAVE_EX_SWITCHLESS_BIT_IDX])) {
+        return SGX_ERROR_INVALID_PARAMETER;
+    }
+    return sgx_create_enclave(file_name, debug, launch_token, launch_token_updated,
+                              enclave_id, misc_attr);
+}
+
+sgx_status_t sgx_destroy_enclave(const sgx_enclave_id_t enclave_id) {
+    return enclave_id == 0 ? SGX_ERROR_INVALID_ENCLAVE_ID : SGX_SUCCESS;
+}
+
+// ---------------------------------------------------------------------------
+// Trusted runtime
+
+sgx_status_t sgx_read_rand(unsigned char* rand, size_t length_in_bytes) {
+    if (!rand || length_in_bytes == 0 || length_in_bytes > INT_MAX) {
+        return SGX_ERROR_INVALID_PARAMETER;
+    }
+    return RAND_bytes(rand, static_cast<int>(length_in_bytes)) == 1 ? SGX_SUCCESS
+                                                                    : SGX_ERROR_UNEXPECTED;
+}
+
+int sgx_is_within_enclave(const void* addr, size_t size) {
+    (void)addr;
+    (void)size;
+    return 1;
+}
+
+int sgx_is_outside_enclave(const void* addr, size_t size) {
+    (void)addr;
+    (void)size;
+    return 1;
+}
+
+void* sgx_register_exception_handler(int is_first_handler,
+                                     sgx_exception_handler_t exception_handler) {
+    (void)is_first_handler;
+    return exception_handler ? &exception_handler_token : NULL;
+}
+
+int sgx_unregister_exception_handler(void* handler) {
+    return handler == &exception_handler_token ? 1 : 0;
+}
+
+uint32_t sgx_spin_lock(sgx_spinlock_t* lock) {
+    while (__atomic_exchange_n(lock, 1u, __ATOMIC_ACQUIRE) != 0) {
+        while (__atomic_load_n(lock, __ATOMIC_RELAXED) != 0) {
+            __asm__ volatile ("pause" ::: "memory");
+        }
+    }
+    return 0;
+}
+
+uint32_t sgx_spin_unlock(sgx_spinlock_t* lock) {
+    __atomic_store_n(lock, 0u, __ATOMIC_RELEASE);
+    return 0;
+}
+
+sgx_status_t sgx_cpuidex(int cpuinfo[4], int leaf, int subleaf) {
+    if (!cpuinfo) return SGX_ERROR_INVALID_PARAMETER;
+    unsigned int regs[4];
+    __cpuid_count(static_cast<unsigned int>(leaf), static_cast<unsigned int>(subleaf),
+                  regs[0], regs[1], regs[2], regs[3]);
+    memcpy(cpuinfo, regs, sizeof(regs));
+    return SGX_SUCCESS;
+}
+
+sgx_status_t sgx_cpuid(int cpuinfo[4], int leaf) {
+    return sgx_cpuidex(cpuinfo, leaf, 0);
+}
+
+const sgx_report_t* sgx_self_report(void) {
+    static const sgx_report_t report = build_self_report();
+    return &report;
+}
+
+sgx_status_t sgx_get_key(const sgx_key_request_t* key_request, sgx_key_128bit_t* key) {
+    if (!key_request || !key) return SGX_ERROR_INVALID_PARAMETER;
+    if (key_request->key_name != SGX_KEYSELECT_SEAL &&
+        key_request->key_name != SGX_KEYSELECT_REPORT) {
+        return SGX_ERROR_INVALID_KEYNAME;
+    }
+
+    // Everything before reserved2 selects the key, as EGETKEY's inputs do
+    uint8_t mac[SGX_HMAC256_MAC_SIZE];
+    unsigned int mac_len = 0;
+    if (!HMAC(EVP_sha256(), kNativeRootKey, sizeof(kNativeRootKey),
+              reinterpret_cast<const unsigned char*>(key_request),
+              offsetof(sgx_key_request_t, reserved2), mac, &mac_len)) {
+        return SGX_ERROR_UNEXPECTED;
+    }
+    memcpy(*key, mac, sizeof(sgx_key_128bit_t));
+    OPENSSL_cleanse(mac, sizeof(mac));
+    return SGX_SUCCESS;
+}
+
+// ---------------------------------------------------------------------------
+// Crypto
+
+sgx_status_t sgx_sha256_msg(const uint8_t* p_src, uint32_t src_len, sgx_sha256_hash_t* p_hash) {
+    if ((!p_src && src_len > 0) || !p_hash) return SGX_ERROR_INVALID_PARAMETER;
+    SHA256(p_src, src_len, *p_hash);
+    return SGX_SUCCESS;
+}
+
+sgx_status_t sgx_rijndael128GCM_encrypt(const sgx_aes_gcm_128bit_key_t* p_key,
+                                        const uint8_t* p_src, uint32_t src_len, uint8_t* p_dst,
+                                        const uint8_t* p_iv, uint32_t iv_len,
+                                        const uint8_t* p_aad, uint32_t aad_len,
+                                        sgx_aes_gcm_128bit_tag_t* p_out_mac) {
+    if (!p_out_mac) return SGX_ERROR_INVALID_PARAMETER;
+    return gcm(true, p_key, p_src, src_len, p_dst, p_iv, iv_len, p_aad, aad_len, *p_out_mac);
+}
+
+sgx_status_t sgx_rijndael128GCM_decrypt(const sgx_aes_gcm_128bit_key_t* p_key,
+                                        const uint8_t* p_src, uint32_t src_len, uint8_t* p_dst,
+                                        const uint8_t* p_iv, uint32_t iv_len,
+                                        const uint8_t* p_aad, uint32_t aad_len,
+                                        const sgx_aes_gcm_128bit_tag_t* p_in_mac) {
+    if (!p_in_mac) return SGX_ERROR_INVALID_PARAMETER;
+    uint8_t tag[SGX_AESGCM_MAC_SIZE];
+    memcpy(tag, *p_in_mac, sizeof(tag));
+    return gcm(false, p_key, p_src, src_len, p_dst, p_iv, iv_len, p_aad, aad_len, tag);
+}
+
+sgx_status_t sgx_hmac_sha256_msg(const unsigned char* p_src, int src_len,
+                                 const unsigned char* p_key, int key_len,
+                                 unsigned char* p_mac, int mac_len) {
+    if ((!p_src && src_len > 0) || src_len < 0 || !p_key || key_len <= 0 ||
+        !p_mac || mac_len != SGX_HMAC256_MAC_SIZE) {
+        return SGX_ERROR_INVALID_PARAMETER;
+    }
+    unsigned int out_len = 0;
+    return HMAC(EVP_sha256(), p_key, key_len, p_src, static_cast<size_t>(src_len),
+                p_mac, &out_len) ? SGX_SUCCESS : SGX_ERROR_UNEXPECTED;
+}
+
+sgx_status_t sgx_ecc256_open_context(sgx_ecc_state_handle_t* p_ecc_handle) {
+    if (!p_ecc_handle) return SGX_ERROR_INVALID_PARAMETER;
+    EC_GROUP* group = EC_GROUP_new_by_curve_name(NID_X9_62_prime256v1);
+    if (!group) return SGX_ERROR_UNEXPECTED;
+    *p_ecc_handle = group;
+    return SGX_SUCCESS;
+}
+
+sgx_status_t sgx_ecc256_close_context(sgx_ecc_state_handle_t ecc_handle) {
+    if (!ecc_handle) return SGX_ERROR_INVALID_PARAMETER;
+    EC_GROUP_free(static_cast<EC_GROUP*>(ecc_handle));
+    return SGX_SUCCESS;
+}
+
+sgx_status_t sgx_ecc256_create_key_pair(sgx_ec256_private_t* p_private, sgx_ec256_public_t* p_public,
+                                        sgx_ecc_state_handle_t ecc_handle) {
+    if (!p_private || !p_public || !ecc_handle) return SGX_ERROR_INVALID_PARAMETER;
+
+    const EC_GROUP* group = static_cast<const EC_GROUP*>(ecc_handle);
+    EC_KEY* ec_key = EC_KEY_new();
+    BIGNUM* x = BN_new();
+    BIGNUM* y = BN_new();
+    sgx_status_t status = SGX_ERROR_UNEXPECTED;
+
+    if (ec_key && x && y && EC_KEY_set_group(ec_key, group) && EC_KEY_generate_key(ec_key) &&
+        EC_POINT_get_affine_coordinates(group, EC_KEY_get0_public_key(ec_key), x, y, NULL) &&
+        bn_to_le(EC_KEY_get0_private_key(ec_key), p_private->r, SGX_ECP256_KEY_SIZE) &&
+        bn_to_le(x, p_public->gx, SGX_ECP256_KEY_SIZE) &&
+        bn_to_le(y, p_public->gy, SGX_ECP256_KEY_SIZE)) {
+        status = SGX_SUCCESS;
+    }
+
+    BN_free(y);
+    BN_free(x);
+    EC_KEY_free(ec_key);
+    return status;
+}
+
+sgx_status_t sgx_ecdsa_sign(const uint8_t* p_data, uint32_t data_size,
+                            const sgx_ec256_private_t* p_private,
+                            sgx_ec256_signature_t* p_signature,
+                            sgx_ecc_state_handle_t ecc_handle) {
+    if ((!p_data && data_size > 0) || !p_private || !p_signature || !ecc_handle) {
+        return SGX_ERROR_INVALID_PARAMETER;
+    }
+
+    uint8_t digest[SGX_SHA256_HASH_SIZE];
+    SHA256(p_data, data_size, digest);
+
+    EC_KEY* ec_key = EC_KEY_new();
+    BIGNUM* priv = BN_lebin2bn(p_private->r, SGX_ECP256_KEY_SIZE, NULL);
+    ECDSA_SIG* sig = NULL;
+    sgx_status_t status = SGX_ERROR_UNEXPECTED;
+
+    if (ec_key && priv && EC_KEY_set_group(ec_key, static_cast<const EC_GROUP*>(ecc_handle)) &&
+        EC_KEY_set_private_key(ec_key, priv)) {
+        sig = ECDSA_do_sign(digest, sizeof(digest), ec_key);
+        if (sig &&
+            bn_to_le(ECDSA_SIG_get0_r(sig), reinterpret_cast<uint8_t*>(p_signature->x),
+                     SGX_ECP256_KEY_SIZE) &&
+            bn_to_le(ECDSA_SIG_get0_s(sig), reinterpret_cast<uint8_t*>(p_signature->y),
+                     SGX_ECP256_KEY_SIZE)) {
+            status = SGX_SUCCESS;
+        }
+    }
+
+    ECDSA_SIG_free(sig);
+    BN_clear_free(priv);
+    EC_KEY_free(ec_key);
+    return status;
+}
+
+// ---------------------------------------------------------------------------
+// Sealing
+
+uint32_t sgx_calc_sealed_data_size(const uint32_t add_mac_txt_size, const uint32_t txt_encrypt_size) {
+    const uint64_t size = static_cast<uint64_t>(sizeof(sgx_sealed_data_t)) +
+                          add_mac_txt_size + txt_encrypt_size;
+    return size > UINT32_MAX ? UINT32_MAX : static_cast<uint32_t>(size);
+}
+
+uint32_t sgx_get_add_mac_txt_len(const sgx_sealed_data_t* p_sealed_data) {
+    if (!p_sealed_data ||
+        p_sealed_data->plain_text_offset > p_sealed_data->aes_data.payload_size) {
+        return UINT32_MAX;
+    }
+    return p_sealed_data->aes_data.payload_size - p_sealed_data->plain_text_offset;
+}
+
+uint32_t sgx_get_encrypt_txt_len(const sgx_sealed_data_t* p_sealed_data) {
+    if (!p_sealed_data ||
+        p_sealed_data->plain_text_offset > p_sealed_data->aes_data.payload_size) {
+        return UINT32_MAX;
+    }
+    return p_sealed_data->plain_text_offset;
+}
+
+sgx_status_t sgx_seal_data(const uint32_t additional_MACtext_length,
+                           const uint8_t* p_additional_MACtext,
+                           const uint32_t text2encrypt_length, const uint8_t* p_text2encrypt,
+                           const uint32_t sealed_data_size, sgx_sealed_data_t* p_sealed_data) {
+    const uint32_t needed = sgx_calc_sealed_data_size(additional_MACtext_length,
+                                                      text2encrypt_length);
+    if (needed == UINT32_MAX || sealed_data_size != needed || !p_sealed_data ||
+        text2encrypt_length == 0 || !p_text2encrypt ||
+        (additional_MACtext_length > 0 && !p_additional_MACtext)) {
+        return SGX_ERROR_INVALID_PARAMETER;
+    }
+
+    memset(p_sealed_data, 0, sizeof(sgx_sealed_data_t));
+    sgx_key_request_t* request = &p_sealed_data->key_request;
+    request->key_name = SGX_KEYSELECT_SEAL;
+    request->key_policy = SGX_KEYPOLICY_MRSIGNER;
+    request->cpu_svn = sgx_self_report()->body.cpu_svn;
+    request->attribute_mask.flags = TSEAL_DEFAULT_FLAGSMASK;
+    request->attribute_mask.xfrm = 0;
+    request->misc_mask = TSEAL_DEFAULT_MISCMASK;
+    sgx_status_t status = sgx_read_rand(request->key_id.id, sizeof(request->key_id.id));
+    if (status != SGX_SUCCESS) return status;
+
+    sgx_key_128bit_t key;
+    status = sgx_get_key(request, &key);
+    if (status != SGX_SUCCESS) return status;
+
+    // Payload: ciphertext, then the additional MAC text in the clear
+    uint8_t* payload = p_sealed_data->aes_data.payload;
+    status = sgx_rijndael128GCM_encrypt(&key, p_text2encrypt, text2encrypt_length, payload,
+                                        kSealIv, sizeof(kSealIv),
+                                        p_additional_MACtext, additional_MACtext_length,
+                                        &p_sealed_data->aes_data.payload_tag);
+    OPENSSL_cleanse(key, sizeof(key));
+    if (status != SGX_SUCCESS) return status;
+
+    if (additional_MACtext_length > 0) {
+        memcpy(payload + text2encrypt_length, p_additional_MACtext, additional_MACtext_length);
+    }
+    p_sealed_data->plain_text_offset = text2encrypt_length;
+    p_sealed_data->aes_data.payload_size = text2encrypt_length + additional_MACtext_length;
+    return SGX_SUCCESS;
+}
+
+sgx_status_t sgx_unseal_data(const sgx_sealed_data_t* p_sealed_data,
+                             uint8_t* p_additional_MACtext, uint32_t* p_additional_MACtext_length,
+                             uint8_t* p_decrypted_text, uint32_t* p_decrypted_text_length) {
+    if (!p_sealed_data || !p_decrypted_text || !p_decrypted_text_length) {
+        return SGX_ERROR_INVALID_PARAMETER;
+    }
+    const uint32_t encrypt_len = sgx_get_encrypt_txt_len(p_sealed_data);
+    const uint32_t mac_txt_len = sgx_get_add_mac_txt_len(p_sealed_data);
+    if (encrypt_len == UINT32_MAX || mac_txt_len == UINT32_MAX ||
+        *p_decrypted_text_length < encrypt_len ||
+        (mac_txt_len > 0 && (!p_additional_MACtext || !p_additional_MACtext_length ||
+                             *p_additional_MACtext_length < mac_txt_len))) {
+        return SGX_ERROR_INVALID_PARAMETER;
+    }
+
+    sgx_key_128bit_t key;
+    sgx_status_t status = sgx_get_key(&p_sealed_data->key_request, &key);
+    if (status != SGX_SUCCESS) return status;
+
+    const uint8_t* payload = p_sealed_data->aes_data.payload;
+    const uint8_t* mac_txt = payload + encrypt_len;
+    status = sgx_rijndael128GCM_decrypt(&key, payload, encrypt_len, p_decrypted_text,
+                                        kSealIv, sizeof(kSealIv),
+                                        mac_txt_len > 0 ? mac_txt : NULL, mac_txt_len,
+                                        &p_sealed_data->aes_data.payload_tag);
+    OPENSSL_cleanse(key, sizeof(key));
+    if (status != SGX_SUCCESS) return status;
+
+    if (mac_txt_len > 0) {
+        memcpy(p_additional_MACtext, mac_txt, mac_txt_len);
+        *p_additional_MACtext_length = mac_txt_len;
+    } else if (p_additional_MACtext_length) {
+        *p_additional_MACtext_length = 0;
+    }
+    *p_decrypted_text_length = encrypt_len;
+    return SGX_SUCCESS;
+}
+
+} // extern "C"